@@ -0,0 +1,60 @@
+#pragma once
+
+#include <QObject>
+#include <QByteArray>
+#include <QPointer>
+
+QT_BEGIN_NAMESPACE
+class QTimer;
+QT_END_NAMESPACE
+
+class CodeEditor;
+class JournalWriter;
+
+// Journals the unsaved edits of one editor.
+// The first edit after a save writes a snapshot, later edits are batched as
+// deltas taken from QTextDocument::contentsChange and handed to the
+// JournalWriter. The log is dropped as soon as the document is clean again.
+class BufferJournal : public QObject
+{
+    Q_OBJECT
+public:
+    BufferJournal(CodeEditor *editor, JournalWriter *writer);
+    ~BufferJournal();
+
+    quint64 id() const {
+        return journal_id;
+    }
+
+    // continues the log of a buffer recovered from a previous run
+    void adopt(quint64 id);
+
+private slots:
+    void contents_changed(int position, int removed, int added);
+    void modification_changed(bool modified);
+    void flush();
+
+private:
+    void write_snapshot();
+    void discard();
+
+    bool is_tracking() const;
+
+private:
+    static constexpr int FLUSH_DELAY_MS = 300;
+    // deltas after which the log is rewritten as a single snapshot
+    static constexpr int COMPACT_RECORDS = 4096;
+
+    CodeEditor *editor;
+    QPointer<JournalWriter> writer; // gone once the save thread has shut down
+
+    quint64 journal_id;
+    bool active = false;
+    bool needs_snapshot = false;
+    int revision = -1; // of the last change journaled
+
+    QByteArray pending;
+    int records = 0;
+
+    QTimer *flush_timer;
+};
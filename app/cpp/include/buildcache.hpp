@@ -0,0 +1,35 @@
+#pragma once
+
+#include <QByteArray>
+#include <QString>
+#include <QStringList>
+
+#include <optional>
+
+// Content-addressed store of compiled binaries.
+// A binary is keyed by the hash of its source, the compiler and the compiler
+// arguments, so rebuilding an unchanged file just copies the previous binary
+// back. The store is bounded in size; the least recently used binaries are
+// evicted first.
+class BuildCache
+{
+public:
+    static QString directory();
+
+    // nullopt if the build can't be cached, e.g. the source includes local headers
+    static std::optional<QByteArray> key(const QString &source_file, const QString &compiler_path,
+                                         const QStringList &compiler_args);
+
+    // copies the cached binary to output_file, false on a miss
+    static bool fetch(const QByteArray &key, const QString &output_file);
+    static void store(const QByteArray &key, const QString &output_file);
+
+    // resolved executable with its size and mtime, empty if it can't be found
+    static QByteArray compiler_identity(const QString &compiler_path);
+
+private:
+    static QString entry_path(const QByteArray &key);
+    static void evict();
+
+    static constexpr qint64 MAX_SIZE = 256 * 1024 * 1024;
+};
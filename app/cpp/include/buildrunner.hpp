@@ -0,0 +1,57 @@
+#pragma once
+
+#include <QObject>
+#include <QElapsedTimer>
+#include <QStringList>
+
+#include <sys/types.h>
+
+#include "ds/buildresult.hpp"
+
+class QSocketNotifier;
+class QTimer;
+
+// Runs one build step at a time as a child process, without a shell.
+// Output is streamed as it arrives, and the exit status, wall time and CPU
+// time are reported once the process has finished.
+// The child is started and reaped by hand rather than through QProcess, so
+// wait4() reports the usage of this compiler and the processes it waited
+// for alone, not of whatever else the IDE reaped meanwhile.
+class BuildRunner : public QObject
+{
+    Q_OBJECT
+public:
+    BuildRunner(QObject *parent = nullptr);
+    ~BuildRunner();
+
+    bool is_running() const {
+        return pid > 0;
+    }
+
+    void start(BuildStep step, const QString &program, const QStringList &arguments,
+               const QString &working_directory);
+    void cancel();
+
+signals:
+    void output(QByteArray data);
+    void finished(BuildResult result);
+
+private slots:
+    void read_output();
+    void check_exited();
+
+private:
+    void close_output();
+
+    // how often the child is checked for having exited
+    static constexpr int REAP_INTERVAL_MS = 10;
+
+    pid_t pid = -1;
+    int output_fd = -1;
+    QSocketNotifier *output_notifier = nullptr;
+    QTimer *reap_timer;
+
+    BuildStep step = BuildStep::COMPILE;
+
+    QElapsedTimer wall_timer;
+};
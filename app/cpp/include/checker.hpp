@@ -0,0 +1,22 @@
+#pragma once
+
+#include <QByteArray>
+#include <QString>
+
+struct CheckResult
+{
+    bool ok = false;
+    QString message; // where the outputs diverge
+};
+
+// Compares a program's output with the expected answer token by token.
+// Whitespace and line breaks only separate tokens; tokens that are both
+// floating-point numbers match within an absolute or relative EPSILON.
+class Checker
+{
+public:
+    static CheckResult compare(const QByteArray &output, const QByteArray &expected);
+
+private:
+    static constexpr double EPSILON = 1e-6;
+};
@@ -2,17 +2,30 @@
 #define CODEEDITOR_H
 
 #include <QPlainTextEdit>
+#include <QPixmap>
+#include <QVector>
+#include <QMap>
+#include <QHash>
+#include <QTextCursor>
+#include <QColor>
 #include <optional>
 
+#include "ds/diagnostic.hpp"
+
 QT_BEGIN_NAMESPACE
 class QPaintEvent;
 class QResizeEvent;
 class QSize;
 class QWidget;
 class QAction;
+class QTextBlock;
 QT_END_NAMESPACE
 
 class LineNumberArea;
+class PieceTable;
+class BufferJournal;
+
+namespace QSourceHighlite { class QSourceHighliter; }
 
 //![codeeditordefinition]
 
@@ -22,11 +35,70 @@ class CodeEditor : public QPlainTextEdit
 
 public:
     CodeEditor(QWidget *parent = nullptr);
+    ~CodeEditor();
+
+    // large-file mode: the file is memory-mapped and only a window of lines is paged into the document
+    bool open_large_file(const QString &file_name, bool read_only);
+    // the current text of a large file, safe to write out on another thread
+    PieceTable large_file_snapshot();
+
+    bool is_large_file() const {
+        return piece_table != nullptr;
+    }
+
+    // while loading the editor is read-only and keeps no undo history
+    void set_loading(bool loading);
+
+    bool is_loading() const {
+        return loading;
+    }
+
+    void setup_highlighter();
+
+    // tab virtualisation: an unloaded editor drops its document contents, layout
+    // and highlighter and keeps only what is needed to rebuild them
+    void unload();
+    void restore_from_buffer();
+    void restore_view_state();
+
+    bool is_unloaded() const {
+        return unloaded;
+    }
+
+    // unloaded editors without a kept buffer have to be re-read from their file
+    bool has_unloaded_buffer() const {
+        return unloaded_buffer.has_value();
+    }
+
+    qint64 memory_estimate() const;
+
+    // turns the document into text through a minimal set of edits, so the
+    // cursor, undo history and highlighting of untouched lines survive
+    void replace_contents(const QString &text);
+
+    // changes with every edit; in large-file mode paging the window doesn't count
+    int save_revision() const;
 
+    // view state and contents for the session file, valid for unloaded editors too
+    int cursor_position() const;
+    int scroll_position() const;
+    QByteArray compressed_contents();
+
+    // turns the editor into an unloaded one with the given state, used on session restore
+    void restore_unloaded(int cursor_position, int scroll_position, bool modified,
+                          const std::optional<QByteArray> &buffer);
 
     void lineNumberAreaPaintEvent(QPaintEvent *event);
     int lineNumberAreaWidth();
 
+    void set_journal(BufferJournal *journal) {
+        this->journal = journal;
+    }
+
+    BufferJournal *get_journal() const {
+        return journal;
+    }
+
     void set_file_name(const QString &file_name) {
         this->file_name = file_name;
     }
@@ -35,24 +107,112 @@ public:
         return file_name;
     }
 
+    // errors and warnings are underlined until the next build replaces them
+    void set_diagnostics(const QVector<Diagnostic> &diagnostics);
+
+    // line and column are 1-based, column 0 means the start of the line
+    void go_to(int line, int column);
+
+    // profiler heat in the line number gutter, 1-based line -> 0..1 relative to the hottest line;
+    // dropped once lines are added or removed, since it would point at the wrong ones
+    void set_line_heat(const QHash<int, double> &heat);
+
 signals:
     void file_opened(QString file_name);
 
 protected:
     void resizeEvent(QResizeEvent *event) override;
+    void changeEvent(QEvent *event) override;
+    void paintEvent(QPaintEvent *event) override;
     void keyPressEvent(QKeyEvent *event) override;
+    bool viewportEvent(QEvent *event) override;
 
 private slots:
     void updateLineNumberAreaWidth(int newBlockCount);
     void highlightCurrentLine();
+    void highlight_matching_bracket();
     void updateLineNumberArea(const QRect &rect, int dy);
+    void slide_window();
 private:
     void add_leading_offset();
+    void dedent_closing_brace();
+
+    void render_digit_pixmaps();
+
+    // squiggles are extra selections, their cursors follow edits on their own
+    void apply_diagnostics();
+    int diagnostic_position(const QTextBlock &block, int column) const;
+
+    // highlights painted by the editor itself instead of extraSelections,
+    // changing one only repaints the rectangles it covers before and after
+    enum class HighlightSlot {
+        CURRENT_LINE,
+        BRACKET_OPEN,
+        BRACKET_CLOSE
+    };
+
+    struct PaintedHighlight {
+        QTextCursor cursor; // painted range, or the position whose line is painted if full_width
+        QColor color;
+        bool full_width = false;
+    };
+
+    void set_highlight(HighlightSlot slot, const QTextCursor &cursor, const QColor &color, bool full_width);
+    void clear_highlight(HighlightSlot slot);
+    QRect highlight_rect(const PaintedHighlight &highlight) const;
+
+    int find_matching_bracket(int pos) const;
+
+    void load_window(qint64 first_line);
+    void commit_window();
+    qint64 window_begin() const;
+    qint64 window_end() const;
 
 private:
-    QWidget *lineNumberArea;
+    static constexpr qint64 LARGE_FILE_WINDOW_LINES = 4000;
+    static constexpr int LARGE_FILE_WINDOW_MARGIN = 500;
+    static constexpr int MAX_BRACKET_SCAN = 10000;
+
+    QWidget *lineNumberArea = nullptr;
+
+    // gutter cache, invalidated on font changes
+    QVector<QPixmap> digit_pixmaps;
+    qreal digit_pixmaps_ratio = 0;
+    int digit_width = 0;
+    int line_number_digits = 0;
+    int line_number_width = 0;
+
+    QMap<HighlightSlot, PaintedHighlight> highlights;
 
     std::optional<QString> file_name;
+
+    QVector<Diagnostic> diagnostics;
+    QVector<QString> squiggle_messages; // parallel to extraSelections()
+
+    QHash<int, double> line_heat;
+
+    BufferJournal *journal = nullptr;
+
+    PieceTable *piece_table = nullptr; // owns the mapped file, shared with pending saves
+    int large_file_edits = 0;
+    qint64 window_first_line = 0;
+    qint64 window_line_count = 0;
+    bool window_dirty = false;
+    bool window_sliding = false;
+
+    bool loading = false;
+
+    QSourceHighlite::QSourceHighliter *highlighter = nullptr;
+
+    bool unloaded = false;
+    std::optional<QByteArray> unloaded_buffer; // compressed utf-8 text of unsaved contents
+    int saved_cursor_position = 0;
+    int saved_scroll_position = 0;
+    bool saved_modified = false;
+
+    // compressed_contents() is only recomputed after the document changed
+    QByteArray compressed_cache;
+    int compressed_cache_revision = -1;
 };
 
 //![codeeditordefinition]
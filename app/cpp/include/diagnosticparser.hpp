@@ -0,0 +1,45 @@
+#pragma once
+
+#include <QObject>
+#include <QByteArray>
+#include <QVector>
+
+#include "ds/diagnostic.hpp"
+
+class QJsonObject;
+
+// Turns GCC/Clang output into diagnostics on a worker thread.
+// Output is fed in chunks as the build runner streams it and parsed line by
+// line, every chunk's new diagnostics are reported at once. Both the usual
+// "file:line:column: severity: message" lines and the array printed by
+// -fdiagnostics-format=json are understood.
+// Each build is tagged with an id, so late results of an older one can be told apart.
+class DiagnosticParser : public QObject
+{
+    Q_OBJECT
+public:
+    DiagnosticParser(QObject *parent = nullptr);
+
+public slots:
+    // relative paths are resolved against working_directory
+    void start(quint64 build_id, const QString &working_directory);
+    void feed(quint64 build_id, const QByteArray &data);
+    void finish(quint64 build_id);
+
+signals:
+    void parsed(quint64 build_id, QVector<Diagnostic> diagnostics);
+
+private:
+    void parse_line(const QByteArray &line, QVector<Diagnostic> &diagnostics);
+    void parse_json(const QByteArray &line, QVector<Diagnostic> &diagnostics);
+    void add_json_diagnostic(const QJsonObject &object, QVector<Diagnostic> &diagnostics);
+    void add(Diagnostic diagnostic, QVector<Diagnostic> &diagnostics);
+
+    // template errors can run into thousands of notes, the rest is only in the terminal
+    static constexpr int MAX_DIAGNOSTICS = 1000;
+
+    quint64 build_id = 0;
+    QString working_directory;
+    QByteArray pending; // incomplete last line
+    int count = 0;
+};
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <QTreeWidget>
+#include <QVector>
+
+#include "ds/diagnostic.hpp"
+
+// Errors and warnings of the last build, notes are nested under the message they explain
+class DiagnosticsPanel : public QTreeWidget
+{
+    Q_OBJECT
+public:
+    DiagnosticsPanel(QWidget *parent = nullptr);
+
+    void reset();
+    void add(const QVector<Diagnostic> &diagnostics);
+
+    int error_count() const {
+        return errors;
+    }
+
+    // e.g. "2 errors, 1 warning"
+    QString summary() const;
+
+signals:
+    // a message was clicked
+    void location_activated(QString file, int line, int column);
+
+private:
+    enum Column { LOCATION, MESSAGE };
+
+    QTreeWidgetItem *last_top_level = nullptr;
+    int errors = 0;
+    int warnings = 0;
+};
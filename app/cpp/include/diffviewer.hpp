@@ -0,0 +1,23 @@
+#pragma once
+
+#include <QDialog>
+
+QT_BEGIN_NAMESPACE
+namespace Ui {class DiffViewer;};
+class QPlainTextEdit;
+QT_END_NAMESPACE
+
+// Shows the expected and actual output side by side around their first difference
+class DiffViewer : public QDialog {
+    Q_OBJECT
+public:
+    DiffViewer(const QString &expected_file, const QString &output_file, QWidget *parent = nullptr);
+    ~DiffViewer();
+
+private:
+    static void show_context(QPlainTextEdit *view, const QStringList &lines, qint64 first_line, qint64 highlighted_line);
+
+    Ui::DiffViewer *ui;
+
+    static constexpr int CONTEXT_LINES = 20;
+};
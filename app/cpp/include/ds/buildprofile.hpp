@@ -0,0 +1,29 @@
+#pragma once
+
+#include <QRegularExpression>
+#include <QString>
+
+// Named set of compiler arguments, e.g. a release or a sanitizer build.
+// They are passed after the common compiler arguments from the preferences.
+struct BuildProfile
+{
+    QString name;
+    QString compiler_args;
+
+    // tells the binaries of different profiles apart, e.g. "Debug (ASan)" -> "debug-asan"
+    QString slug() const {
+        static const QRegularExpression separators("[^a-z0-9]+");
+
+        QString result = name.toLower();
+        result.replace(separators, "-");
+
+        while (result.startsWith('-')) {
+            result.remove(0, 1);
+        }
+        while (result.endsWith('-')) {
+            result.chop(1);
+        }
+
+        return result.isEmpty() ? "default" : result;
+    }
+};
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <QString>
+
+enum class BuildStep {
+    COMPILE
+};
+
+struct BuildResult
+{
+    BuildStep step = BuildStep::COMPILE;
+    bool started = false;  // false if the program couldn't be launched at all
+    bool crashed = false;
+    bool cached = false;   // the binary was taken from the build cache
+    int exit_code = -1;
+    qint64 wall_time_ms = 0;
+    qint64 cpu_time_ms = 0; // user + system
+    QString error;
+
+    bool success() const {
+        return started && !crashed && exit_code == 0;
+    }
+};
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <QString>
+
+enum class DiagnosticSeverity {
+    ERROR,
+    WARNING,
+    NOTE
+};
+
+// One compiler message with its location, lines and columns are 1-based
+struct Diagnostic
+{
+    QString file;
+    int line = 0;
+    int column = 0; // 0 if the compiler didn't report one
+    DiagnosticSeverity severity = DiagnosticSeverity::ERROR;
+    QString message;
+};
@@ -1,18 +1,30 @@
 #pragma once
 
 #include "shortcuttype.hpp"
+#include "buildprofile.hpp"
 
 #include <unordered_map>
 #include <QString>
 #include <QShortcut>
 #include <QFont>
 #include <QKeySequence>
+#include <QVector>
 
 struct Preferences {
     QString compiler_path;
-    QString compiler_args;
+    QString compiler_args; // passed to every build profile
+
+    // never empty, the first one is used for files without a profile of their own
+    QVector<BuildProfile> build_profiles;
 
     QFont editor_font;
 
+    // files bigger than this are opened in large-file mode (bytes)
+    qint64 large_file_size;
+    // files bigger than this are opened read-only (bytes)
+    qint64 read_only_file_size;
+    // background tabs are unloaded once all editors together exceed this (bytes)
+    qint64 tab_memory_budget;
+
     QMap <ShortcutType, QKeySequence> shortcuts;
 };
\ No newline at end of file
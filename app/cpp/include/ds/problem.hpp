@@ -9,6 +9,7 @@ struct Problem
 {
 public:
     QString title;
+    QString url; // where it was loaded from, identifies the problem across sources
     int32_t time_limit_ms;
     QString memory_limit;
     QString source_size_limit;
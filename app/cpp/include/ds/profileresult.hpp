@@ -0,0 +1,21 @@
+#pragma once
+
+#include <QHash>
+#include <QString>
+
+#include "ds/runresult.hpp"
+
+// Where a program spent its CPU time on one test
+struct ProfileResult
+{
+    QString test_name;
+    RunResult run;
+
+    QHash<int, quint64> line_samples; // 1-based line of the source file -> samples
+    quint64 total_samples = 0;
+    quint64 source_samples = 0;  // mapped to a line of the source file
+    quint64 outside_samples = 0; // in shared libraries
+    quint64 lost_samples = 0;    // dropped by the kernel
+
+    QString error;
+};
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <QByteArray>
+#include <QString>
+
+// Resource limits of a single run, 0 means unlimited
+struct RunLimits
+{
+    qint64 cpu_time_ms = 0;
+    qint64 wall_time_ms = 0;
+    qint64 memory_kb = 0;    // address space
+
+    // built with -fsanitize: the sanitizer's shadow memory needs terabytes of
+    // address space, so only resident memory can be limited and measured
+    bool sanitized = false;
+};
+
+// Outcome of running a program to completion on a fixed input
+struct RunResult
+{
+    bool started = false;  // false if the program couldn't be launched at all
+    bool signaled = false;
+    int exit_code = -1;
+    int signal = 0;        // terminating signal if signaled
+
+    qint64 wall_time_ms = 0;
+    qint64 cpu_time_ms = 0; // user + system
+    qint64 user_time_ms = 0;
+    qint64 system_time_ms = 0;
+    qint64 peak_memory_kb = 0;         // resident
+    qint64 peak_virtual_memory_kb = 0; // address space, what the memory limit applies to
+
+    bool wall_time_exceeded = false; // killed for running past the wall limit
+    // ran under ptrace; false if the kernel refused it (Yama ptrace_scope),
+    // then peak memory is unknown and the program can't be profiled
+    bool traced = false;
+
+    QByteArray output;
+    QByteArray error_output;
+    bool output_truncated = false;
+
+    QString error;
+};
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <QString>
+#include <QByteArray>
+#include <QVector>
+
+#include <optional>
+
+struct SessionTab
+{
+    QString name;
+    std::optional<QString> file_name;
+    qint32 cursor_position = 0;
+    qint32 scroll_position = 0;
+    QVector<qint32> folded_blocks;
+    bool modified = false;
+    QByteArray buffer; // qCompress'ed utf-8 contents, empty for clean file tabs
+    quint64 journal_id = 0; // autosave journal that may hold newer edits than buffer
+};
+
+struct Session
+{
+    qint32 current_tab = -1;
+    QVector<SessionTab> tabs;
+};
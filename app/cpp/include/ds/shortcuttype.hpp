@@ -9,5 +9,7 @@ enum class ShortcutType {
     TAB_PREV,
     FOLER_OPEN,
     RUN_COMPILE,
-    RUN_EXEC
+    RUN_EXEC,
+    RUN_COMPILE_EXEC,
+    RUN_TESTS
 };
\ No newline at end of file
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <QByteArray>
+#include <QString>
+
+#include "ds/testresult.hpp"
+
+// First case on which the solution disagreed with the brute force
+struct StressFailure
+{
+    quint64 seed = 0;
+    Verdict verdict = Verdict::FAILED; // FAILED if the generator or brute force broke
+    QByteArray input;
+    QByteArray expected; // brute-force output
+    QByteArray output;   // solution output
+    QString message;     // verdict and details
+};
@@ -0,0 +1,10 @@
+#pragma once
+
+// Per-tab state that the tab title is built from; the file path itself lives
+// in the editor.
+struct TabInfo
+{
+    int untitled_id = 0; // 0 once the tab has a file
+    bool dirty = false;  // mirrors QTextDocument::isModified()
+    int load_percent = -1; // -1 unless the file is being read
+};
@@ -0,0 +1,12 @@
+#pragma once
+
+#include <QString>
+
+// One stored test, the files live in the problem's test directory
+struct TestCase
+{
+    QString name;
+    QString input_file;
+    QString expected_file;
+    QString output_file; // what the solution printed on its last run
+};
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <QString>
+
+#include "ds/runresult.hpp"
+
+enum class Verdict {
+    ACCEPTED,
+    WRONG_ANSWER,
+    RUNTIME_ERROR,
+    TIME_LIMIT,
+    MEMORY_LIMIT,
+    FAILED          // the program couldn't be started
+};
+
+struct TestResult
+{
+    int index = 0;
+    Verdict verdict = Verdict::FAILED;
+    RunResult run;
+    QString message; // checker or launch error details
+};
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <QObject>
+#include <QString>
+
+// Reads a file in chunks on a worker thread and hands decoded text back to
+// the GUI thread, so opening big files never blocks the event loop.
+// The owning thread can cancel a load with QThread::requestInterruption().
+class FileLoader : public QObject
+{
+    Q_OBJECT
+public:
+    FileLoader(const QString &file_name, QObject *parent = nullptr);
+
+public slots:
+    void load();
+
+signals:
+    void chunk_loaded(QString text, int percent);
+    void finished();
+    void failed(QString error);
+
+private:
+    static constexpr qint64 CHUNK_SIZE = 512 * 1024;
+
+    QString file_name;
+};
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <QObject>
+#include <QString>
+
+QT_BEGIN_NAMESPACE
+class QSaveFile;
+QT_END_NAMESPACE
+
+class PieceTable;
+
+// Writes document snapshots on a worker thread.
+// Every save goes to a temporary file which is fsync'ed and renamed over the
+// target, so a crash mid-save never leaves a truncated file behind.
+// Saves queued to the same FileSaver are written in order.
+class FileSaver : public QObject
+{
+    Q_OBJECT
+public:
+    FileSaver(QObject *parent = nullptr);
+
+public slots:
+    void save(quint64 id, const QString &file_name, const QString &contents);
+    // large-file mode, the pieces still point into the mapped original
+    void save_pieces(quint64 id, const QString &file_name, const PieceTable &pieces);
+
+signals:
+    void saved(quint64 id);
+    void failed(quint64 id, QString error);
+
+private:
+    void commit(quint64 id, const QString &file_name, QSaveFile &file);
+};
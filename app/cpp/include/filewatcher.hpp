@@ -0,0 +1,43 @@
+#pragma once
+
+#include <QObject>
+#include <QHash>
+#include <QSet>
+#include <QString>
+
+QT_BEGIN_NAMESPACE
+class QFileSystemWatcher;
+class QTimer;
+QT_END_NAMESPACE
+
+// Reports changes of open files made by other programs.
+// Bursts of events (a generator writing its output line by line) are merged
+// into one notification per file. Parent directories are watched as well, so
+// files replaced through a rename are picked up again.
+class FileWatcher : public QObject
+{
+    Q_OBJECT
+public:
+    FileWatcher(QObject *parent = nullptr);
+
+    void watch(const QString &file_name);
+    void unwatch(const QString &file_name);
+
+signals:
+    void file_changed(const QString &file_name);
+
+private slots:
+    void path_changed(const QString &path);
+    void directory_changed(const QString &path);
+    void flush();
+
+private:
+    static constexpr int DEBOUNCE_MS = 150;
+
+    QFileSystemWatcher *watcher;
+    QTimer *debounce_timer;
+
+    QSet<QString> files;
+    QHash<QString, int> directories; // watched files per directory
+    QSet<QString> pending;
+};
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <QByteArray>
+#include <QString>
+#include <QVector>
+
+#include <optional>
+
+struct RecoveredBuffer
+{
+    std::optional<QString> file_name;
+    QString text;
+};
+
+// On-disk format of the autosave journal.
+// Every unsaved buffer has its own log: a header naming the file, a snapshot
+// of the whole text and then one record per edit. A torn record at the end of
+// a log (crash mid-write) is dropped on replay.
+class Journal
+{
+public:
+    static QString directory();
+    static QString file_path(quint64 id);
+
+    // ids of all logs currently on disk
+    static QVector<quint64> list();
+    static void clear();
+
+    static QByteArray encode_header(const std::optional<QString> &file_name);
+    static QByteArray encode_snapshot(const QString &text);
+    static QByteArray encode_delta(int position, int removed, const QString &text);
+
+    static std::optional<RecoveredBuffer> replay(quint64 id);
+
+private:
+    enum RecordType : quint8 { SNAPSHOT, DELTA };
+
+    static constexpr quint32 MAGIC = 0x434a4e4c; // "CJNL"
+    static constexpr quint16 VERSION = 1;
+};
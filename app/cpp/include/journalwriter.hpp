@@ -0,0 +1,31 @@
+#pragma once
+
+#include <QObject>
+#include <QByteArray>
+#include <QHash>
+
+QT_BEGIN_NAMESPACE
+class QFile;
+QT_END_NAMESPACE
+
+// Appends journal records on a worker thread.
+// Logs stay open between appends and every append is fdatasync'ed, so a
+// record is on disk once the next one is queued.
+class JournalWriter : public QObject
+{
+    Q_OBJECT
+public:
+    JournalWriter(QObject *parent = nullptr);
+    ~JournalWriter();
+
+public slots:
+    // atomically replaces the log, used for the first snapshot and compaction
+    void replace(quint64 id, const QByteArray &bytes);
+    void append(quint64 id, const QByteArray &bytes);
+    void discard(quint64 id);
+
+private:
+    void close(quint64 id);
+
+    QHash<quint64, QFile*> files;
+};
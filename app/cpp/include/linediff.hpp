@@ -0,0 +1,29 @@
+#pragma once
+
+#include <QString>
+#include <QStringList>
+
+struct LineDifference
+{
+    bool identical = true;
+    qint64 line = 0;               // first differing line, 1-based
+    qint64 first_context_line = 0; // line number of the first context line
+    QStringList expected_context;
+    QStringList output_context;
+};
+
+// Finds the first line where two files differ.
+// Both files are streamed line by line in lockstep and every line is reduced to
+// a hash of its contents without trailing whitespace, so multi-megabyte outputs
+// are compared without being loaded; only a few lines around the divergence are
+// kept for display.
+class LineDiff
+{
+public:
+    static LineDifference first_difference(const QString &expected_file, const QString &output_file,
+                                           int context_lines);
+
+private:
+    // longer lines are cut for display, they are still compared in full
+    static constexpr int MAX_PREVIEW = 512;
+};
@@ -1,8 +1,25 @@
 #pragma once
 
 #include <QMainWindow>
+#include <QHash>
+#include <QSet>
+#include <QList>
+#include <QPointer>
+#include <QElapsedTimer>
+
+#include <optional>
 
 #include "ds/preferences.hpp"
+#include "ds/buildresult.hpp"
+#include "ds/problem.hpp"
+#include "ds/testresult.hpp"
+#include "ds/stressfailure.hpp"
+#include "ds/testcase.hpp"
+#include "ds/diagnostic.hpp"
+#include "ds/profileresult.hpp"
+#include "ds/session.hpp"
+#include "ds/tabinfo.hpp"
+#include "tabregistry.hpp"
 
 QT_BEGIN_NAMESPACE
 namespace Ui { class MainWindow; }
@@ -12,9 +29,25 @@ class QMenu;
 class QShowEvent;
 class CodeEditor;
 class QVariant;
+class QThread;
+class QEvent;
+class QTimer;
+class QDockWidget;
+class QActionGroup;
 QT_END_NAMESPACE
 
 class CodeforcesWrapper;
+class FileSaver;
+class JournalWriter;
+class FileWatcher;
+class BuildRunner;
+class PchBuilder;
+class TestRunner;
+class TestPanel;
+class StressTester;
+class DiagnosticParser;
+class DiagnosticsPanel;
+class Profiler;
 struct CodeforcesProblem;
 
 class MainWindow : public QMainWindow
@@ -26,6 +59,8 @@ public:
     ~MainWindow();
 signals:
     void get_problem(QString url);
+protected:
+    bool event(QEvent *event) override;
 private slots:
     // tab
     void open_new_tab();
@@ -33,7 +68,21 @@ private slots:
     void close_current_tab();
     void next_tab();
     void prev_tab();
-    void set_current_tab_saved(bool status);
+    void tab_activated(int index);
+
+    // deferred until the first paint
+    void restore_session();
+
+    // session file
+    void schedule_session_write();
+    void write_session();
+
+    // background saving
+    void file_saved(quint64 id);
+    void file_save_failed(quint64 id, QString error);
+
+    // reloads clean tabs whose file was changed by another program
+    void file_changed_on_disk(const QString &file_name);
 
     // file
     void ask_open_file();
@@ -49,6 +98,28 @@ private slots:
     // run
     void compile();
     void execute();
+    void compile_and_execute();
+    void run_tests();
+    void compare_profiles();
+    void profile_run();
+    void profile_finished(const ProfileResult &result);
+    void build_finished(const BuildResult &result);
+    void test_finished(const TestResult &result);
+    void tests_finished();
+    void show_test_diff(int index);
+
+    // build profiles
+    void profile_selected(QAction *action);
+
+    // compiler diagnostics
+    void diagnostics_parsed(quint64 id, const QVector<Diagnostic> &diagnostics);
+    void show_diagnostic(const QString &file_name, int line, int column);
+
+    // stress testing
+    void stress_test();
+    void stress_progress(quint64 cases_done);
+    void stress_failed(const StressFailure &failure);
+    void stress_finished(quint64 cases_done, bool failed);
 
     // focus
     void terminal_focus();
@@ -67,18 +138,69 @@ private slots:
     void show_folder_context_menu(const QPoint &point) const;
 private:
 
-    void open_file(const QString &file_name);
-    void save_file(const QString &file_name);
+    CodeEditor *add_editor_tab(bool activate);
+
+    void open_file(const QString &file_name, bool activate = true);
+    void open_large_file(const QString &file_name);
+    void load_file_async(CodeEditor *editor, const QString &file_name);
+    void save_file(CodeEditor *editor, const QString &file_name);
+
+    // tab virtualisation
+    void materialize_tab(CodeEditor *editor);
+    void evict_tabs();
+
+    // tab titles
+    int take_untitled_id();
+    void restore_untitled_id(CodeEditor *editor, const QString &tab_name);
+    QString tab_name(CodeEditor *editor) const;
+    void update_tab_title(CodeEditor *editor);
 
     void open_folder(const QString &folder_name);
 
+    // what happens once the build succeeds
+    enum class AfterBuild { NOTHING, EXECUTE, TEST, COMPARE, STRESS, PROFILE };
+
+    struct BuildJob
+    {
+        QString source;
+        BuildProfile profile;
+    };
+
+    void start_compile(AfterBuild after);
+    // builds the jobs one after another, stops at the first failure
+    void start_build(const QVector<BuildJob> &jobs, AfterBuild after);
+    void build_next();
+    bool load_tests();
+    void run_stored_tests(const QVector<BuildProfile> &profiles);
+    void run_profile_tests();
+    std::optional<QString> test_store_key() const;
+    void start_stress();
+    void start_profile();
+
+    QString executable_path(const QString &file_name, const BuildProfile &profile) const;
+    QStringList compiler_arguments(const BuildProfile &profile) const;
+    BuildProfile file_profile(const QString &file_name) const;
+    RunLimits run_limits(const BuildProfile &profile) const;
+    BuildJob build_job(const QString &file_name) const;
+    void update_profile_menu();
+    void rebuild_profile_menu();
+
     QString get_opened_folder() const;
 
     void write_settings();
     void read_settings();
 
+    void log_startup_interactive();
+
+    void restore_session_tab(const SessionTab &tab);
+    void recover_journals();
+    Session collect_session();
+
     CodeEditor* get_cur_editor() const;
-    CodeEditor *get_tab_editor(uint8_t tab_ind) const;
+    CodeEditor *get_tab_editor(int tab_ind) const;
+
+    // sets the editor's file and keeps the tab registry in sync
+    void set_editor_file(CodeEditor *editor, const QString &file_name);
 
     void setup_folder_context_menu();
 private:
@@ -94,6 +216,93 @@ private:
 
     CodeforcesWrapper *wrapper;
 
+    struct PendingSave
+    {
+        QPointer<CodeEditor> editor;
+        int revision;
+    };
+
+    QThread *save_thread;
+    FileSaver *file_saver;
+    JournalWriter *journal_writer;
+    QHash<quint64, PendingSave> pending_saves;
+    quint64 next_save_id = 0;
+
+    QList<QPointer<CodeEditor>> tab_lru; // most recently activated first
+    bool restoring_session = false;
+    bool session_restored = false;
+
+    static constexpr int SESSION_WRITE_INTERVAL_MS = 2000;
+    // a window started minimized or hidden may never be painted
+    static constexpr int SESSION_RESTORE_FALLBACK_MS = 1000;
+    QTimer *session_timer;
+
+    // startup instrumentation
+    QElapsedTimer startup_timer;
+    bool first_paint_done = false;
+    bool startup_interactive = false;
+
+    TabRegistry tab_registry;
+    FileWatcher *file_watcher;
+
+    BuildRunner *build_runner;
+    PchBuilder *pch_builder;
+    AfterBuild after_build = AfterBuild::NOTHING;
+    QVector<BuildJob> build_queue;
+    QString build_output;
+    std::optional<QByteArray> build_cache_key;
+    quint64 build_id = 0; // tags the diagnostics of each build
+
+    QThread *diagnostics_thread;
+    DiagnosticParser *diagnostic_parser;
+    DiagnosticsPanel *diagnostics_panel;
+    QDockWidget *diagnostics_dock;
+    QHash<QString, QVector<Diagnostic>> build_diagnostics; // by canonical path
+
+    struct PendingLocation
+    {
+        QPointer<CodeEditor> editor;
+        int line;
+        int column;
+    };
+
+    // where to go once the file being loaded is ready
+    std::optional<PendingLocation> pending_location;
+
+    TestRunner *test_runner;
+    TestPanel *test_panel;
+    QDockWidget *test_dock;
+    QVector<TestCase> tests; // of the current or last test run
+    QVector<TestCase> test_rows; // tests repeated for every compared profile
+    QString test_source;
+    QVector<BuildProfile> test_profiles;
+    int test_profile_index = 0;
+    int profile_passed = 0;
+    qint64 profile_cpu_time_ms = 0;
+    qint64 profile_max_cpu_time_ms = 0;
+
+    Profiler *profiler;
+    TestCase profiled_test;
+
+    QMenu *profile_menu;
+    QActionGroup *profile_group;
+    QHash<QString, QString> file_profiles; // canonical path -> profile name, if not the default
+
+    StressTester *stress_tester;
+    QString stress_solution;
+    QString stress_brute;
+    QString stress_generator;
+    quint64 stress_cases = 0;
+    std::optional<QString> stress_store_key; // failing cases are added to these tests
+
+    // examples of the last loaded problem
+    std::optional<Problem> current_problem;
+
+    static constexpr int STATUS_MESSAGE_MS = 5000;
+
+    QHash<CodeEditor*, TabInfo> tab_infos;
+    QSet<int> untitled_ids;
+
     Preferences preferences;
 
     int prev_terminal_height = 0; // need this to re-open terminal on shortcut with the same height
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <QObject>
+#include <QProcess>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+
+// Maintains a precompiled <bits/stdc++.h> per compiler and flags combination.
+// Each combination gets its own include directory with a wrapper header and
+// the .gch next to it; putting that directory first on the include path makes
+// GCC pick the precompiled header up, and fall back to the real one through
+// the wrapper if it doesn't match.
+class PchBuilder : public QObject
+{
+    Q_OBJECT
+public:
+    PchBuilder(QObject *parent = nullptr);
+
+    static QString directory();
+
+    // starts building the header in the background unless it's ready or failed before
+    void prepare(const QString &compiler_path, const QStringList &compiler_args);
+
+    // arguments to add to the compile command, empty until the header is ready
+    QStringList include_arguments(const QString &compiler_path, const QStringList &compiler_args) const;
+
+signals:
+    void ready();
+
+private slots:
+    void process_finished(int exit_code, QProcess::ExitStatus exit_status);
+
+private:
+    static QString key(const QString &compiler_path, const QStringList &compiler_args);
+    static QString header_path(const QString &key);
+    static void evict(const QString &keep);
+
+    QProcess *process;
+    QString building_key;
+    QString killed_key; // its partial output is removed once the process is gone
+
+    // the combination to build after the killed one finishes
+    QString queued_compiler_path;
+    QStringList queued_compiler_args;
+
+    // combinations the compiler refused, e.g. no libstdc++ or not GCC-compatible
+    QSet<QString> failed_keys;
+
+    static constexpr int MAX_HEADERS = 4;
+};
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <QByteArray>
+#include <QtGlobal>
+
+#include <memory>
+#include <vector>
+
+QT_BEGIN_NAMESPACE
+class QIODevice;
+QT_END_NAMESPACE
+
+// Piece table over a read-only original buffer (usually a memory-mapped file).
+// Edits only ever append to the "added" buffer, so the original bytes are never
+// copied; every piece caches its newline count so line lookups only have to
+// scan inside a single piece.
+// A copy is a cheap snapshot: it shares the original and the added buffer.
+class PieceTable
+{
+public:
+    // owner keeps the original buffer alive for as long as any copy exists
+    PieceTable(const char *original, qint64 original_size, std::shared_ptr<const void> owner = nullptr);
+
+    qint64 size() const { return total_size; }
+    qint64 line_count() const { return total_breaks + 1; }
+
+    // byte offset of the first character of the line, size() if out of range
+    qint64 line_offset(qint64 line) const;
+
+    QByteArray read(qint64 pos, qint64 len) const;
+
+    void insert(qint64 pos, const QByteArray &bytes);
+    void remove(qint64 pos, qint64 len);
+
+    bool write_to(QIODevice *device) const;
+
+private:
+    struct Piece
+    {
+        bool added;
+        qint64 start;
+        qint64 length;
+        qint64 line_breaks;
+    };
+
+    const char *buffer(bool added) const;
+
+    qint64 count_breaks(bool added, qint64 start, qint64 length) const;
+
+    qint64 original_breaks_before(qint64 offset) const;
+    qint64 original_break_end(qint64 n) const;
+
+    Piece make_piece(bool added, qint64 start, qint64 length) const;
+
+private:
+    // every LINE_INDEX_STEP-th line start of the original buffer is indexed
+    static constexpr qint64 LINE_INDEX_STEP = 1024;
+
+    const char *original;
+    qint64 original_size;
+    std::shared_ptr<const void> owner;
+
+    QByteArray added;
+
+    std::vector<Piece> pieces;
+    std::vector<qint64> original_index;
+
+    qint64 total_size = 0;
+    qint64 total_breaks = 0;
+};
@@ -17,6 +17,9 @@ public:
 private slots:
     void choose_editor_font();
 
+    void add_profile();
+    void remove_profile();
+
     void save();
 private:
     Ui::PreferencesDialog *ui;
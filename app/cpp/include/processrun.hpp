@@ -0,0 +1,34 @@
+#pragma once
+
+#include <QByteArray>
+#include <QString>
+#include <QStringList>
+
+#include "ds/runresult.hpp"
+
+class Sampler;
+
+// Runs a program synchronously with its input fed through a pipe.
+// The child is reaped with wait4(), so the reported CPU time belongs to that
+// process alone even when several runs happen in parallel. ru_maxrss would
+// also count the IDE's own memory inherited through fork(), so the peak is read
+// from /proc while the child is held at its ptrace exit stop instead.
+// Limits are applied with setrlimit() in the child; the wall-clock limit is
+// enforced by killing the child. Meant to be called from worker threads.
+class ProcessRun
+{
+public:
+    // the sampler, if any, is attached before the program's first instruction
+    static RunResult run(const QString &executable, const QStringList &arguments, const QByteArray &input,
+                         const QString &working_directory, const RunLimits &limits = {},
+                         Sampler *sampler = nullptr);
+
+private:
+    // anything past this is read and dropped, so a runaway program can't exhaust memory
+    static constexpr qint64 MAX_OUTPUT = 64 * 1024 * 1024;
+    static constexpr qint64 MAX_ERROR_OUTPUT = 64 * 1024;
+
+    static constexpr int POLL_INTERVAL_MS = 2;
+    // output still arriving this long after the exit is dropped
+    static constexpr qint64 DRAIN_AFTER_EXIT_MS = 500;
+};
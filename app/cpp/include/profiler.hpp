@@ -0,0 +1,36 @@
+#pragma once
+
+#include <QObject>
+#include <QThreadPool>
+
+#include "ds/profileresult.hpp"
+#include "ds/testcase.hpp"
+
+// Runs a solution on one test with its instruction pointer sampled, then maps
+// the samples to lines of the source file with addr2line.
+// The binary needs debug info; code inlined from headers is charged to the
+// innermost line of the source file it was inlined into.
+class Profiler : public QObject
+{
+    Q_OBJECT
+public:
+    Profiler(QObject *parent = nullptr);
+    ~Profiler();
+
+    // limits are the problem's; only the wall-clock one is kept, so a slow run still gets profiled
+    void run(const QString &executable, const QString &source_file, const TestCase &test, const RunLimits &limits);
+
+signals:
+    void finished(ProfileResult result);
+
+private:
+    static void map_lines(const QString &executable, const QString &source_file,
+                          const QHash<quint64, quint64> &samples, ProfileResult &result);
+
+    static constexpr int ADDR2LINE_TIMEOUT_MS = 60000;
+
+    QThreadPool pool;
+
+    // bumped on every run, so the result of an older one is ignored
+    quint64 generation = 0;
+};
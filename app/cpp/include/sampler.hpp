@@ -0,0 +1,74 @@
+#pragma once
+
+#include <QHash>
+#include <QString>
+
+#include <sys/types.h>
+
+// Samples the instruction pointer of a child process with perf_event_open().
+// ProcessRun attaches it while the program is held right after exec, so the
+// whole run is covered, and drains the ring buffer as the program runs.
+// Addresses inside the executable are translated back to its ELF image, so
+// they can be handed to addr2line as they are; samples in shared libraries
+// are only counted.
+class Sampler
+{
+public:
+    Sampler() = default;
+    ~Sampler();
+
+    Sampler(const Sampler &) = delete;
+    Sampler &operator=(const Sampler &) = delete;
+
+    // false if the kernel refused, see error()
+    bool attach(pid_t pid);
+    void collect();
+    void detach();
+
+    // image address -> number of samples
+    const QHash<quint64, quint64> &samples() const {
+        return image_samples;
+    }
+
+    quint64 total() const {
+        return total_samples;
+    }
+
+    // samples outside the executable, e.g. in libc or libstdc++
+    quint64 outside() const {
+        return outside_samples;
+    }
+
+    quint64 lost() const {
+        return lost_samples;
+    }
+
+    QString error() const {
+        return last_error;
+    }
+
+private:
+    // 10 kHz of the program's own CPU time
+    static constexpr quint64 SAMPLE_PERIOD_NS = 100000;
+    // ring buffer size in pages, has to be a power of two
+    static constexpr size_t DATA_PAGES = 64;
+
+    bool find_image(pid_t pid);
+    void add_sample(quint64 ip);
+
+    int fd = -1;
+    void *buffer = nullptr;
+    size_t buffer_size = 0;
+
+    // where the executable is mapped, and what to subtract to get image addresses
+    quint64 image_begin = 0;
+    quint64 image_end = 0;
+    quint64 image_bias = 0;
+
+    QHash<quint64, quint64> image_samples;
+    quint64 total_samples = 0;
+    quint64 outside_samples = 0;
+    quint64 lost_samples = 0;
+
+    QString last_error;
+};
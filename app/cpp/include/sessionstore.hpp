@@ -0,0 +1,24 @@
+#pragma once
+
+#include <QString>
+
+#include <optional>
+
+#include "ds/session.hpp"
+
+// Versioned binary session file.
+// The file starts with a magic number and a format version followed by a
+// QDataStream body; it is replaced atomically on every write and read back
+// through a single mmap at startup.
+class SessionStore
+{
+public:
+    static QString default_path();
+
+    static std::optional<Session> read(const QString &file_name);
+    static bool write(const QString &file_name, const Session &session);
+
+private:
+    static constexpr quint32 MAGIC = 0x43534553; // "CSES"
+    static constexpr quint16 VERSION = 2;
+};
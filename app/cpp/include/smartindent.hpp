@@ -0,0 +1,42 @@
+#pragma once
+
+#include <QString>
+
+QT_BEGIN_NAMESPACE
+class QTextBlock;
+QT_END_NAMESPACE
+
+// C/C++ indentation rules used by CodeEditor.
+// Everything works on QTextBlocks around the edit, the document is never
+// converted to a string.
+class SmartIndent
+{
+public:
+    static constexpr QChar UNIT = '\t';
+
+    // indentation of a line inserted right after the block
+    static QString indent_after(const QTextBlock &block);
+
+    static QString leading_whitespace(const QString &text);
+
+    // removes one indentation unit (a tab or a tab stop worth of spaces)
+    static QString dedent(const QString &indent);
+
+    // code part of the line, without the trailing comment and surrounding whitespace
+    static QString code(const QString &text);
+
+    static bool opens_scope(const QString &code);
+    static bool is_label(const QString &code);
+    // braceless if/for/while/else/do, the next line is their body
+    static bool is_control_header(const QString &code);
+    // ends with a binary operator, the expression goes on on the next line
+    static bool is_operator_continuation(const QString &code);
+    // either of the above: the statement doesn't end on this line
+    static bool is_continuation(const QString &code);
+
+private:
+    // continuation chains longer than this are not followed back to their start
+    static constexpr int MAX_CHAIN = 64;
+
+    static constexpr int TAB_STOP = 4;
+};
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <QDialog>
+
+QT_BEGIN_NAMESPACE
+namespace Ui {class StressDialog;};
+class QLineEdit;
+QT_END_NAMESPACE
+
+// Picks the sources of a stress test session
+class StressDialog : public QDialog {
+    Q_OBJECT
+public:
+    StressDialog(QWidget *parent = nullptr);
+    ~StressDialog();
+
+    void set_sources(const QString &solution, const QString &brute, const QString &generator);
+    void set_cases(int cases);
+
+    QString solution() const;
+    QString brute() const;
+    QString generator() const;
+    int cases() const;
+
+public slots:
+    void accept() override;
+
+private:
+    void browse(QLineEdit *input);
+
+    Ui::StressDialog *ui;
+};
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <QObject>
+#include <QString>
+#include <QThreadPool>
+
+#include <atomic>
+#include <memory>
+
+#include "ds/runresult.hpp"
+#include "ds/stressfailure.hpp"
+
+// Compares a solution with a brute force on generated inputs.
+// The generator gets the case number as its only argument and prints one
+// input. Every pool thread works through cases on its own until one of them
+// finds a mismatch, the brute force or generator fails, or all cases are done.
+class StressTester : public QObject
+{
+    Q_OBJECT
+public:
+    StressTester(QObject *parent = nullptr);
+    ~StressTester();
+
+    bool is_running() const {
+        return state != nullptr;
+    }
+
+    // solution_limits are the problem's, 0 means unlimited
+    void start(const QString &generator, const QString &brute, const QString &solution,
+               const QString &working_directory, quint64 cases, const RunLimits &solution_limits);
+    void cancel();
+
+signals:
+    void progress(quint64 cases_done);
+    void failed(StressFailure failure);
+    // failed is set if the session ended on a reported failure
+    void finished(quint64 cases_done, bool failed);
+
+private:
+    // shared by the tasks of one session, outlives it if cancelled mid-run
+    struct State
+    {
+        std::atomic<quint64> next_case{1};
+        std::atomic<quint64> cases_done{0};
+        std::atomic<bool> stop{false};
+        std::atomic<bool> failed{false};
+        std::atomic<int> workers{0};
+    };
+
+    void run_worker(std::shared_ptr<State> run_state, QString generator, QString brute, QString solution,
+                    QString working_directory, quint64 cases, RunLimits solution_limits);
+
+    void worker_finished(const std::shared_ptr<State> &run_state);
+
+    QThreadPool pool;
+    std::shared_ptr<State> state;
+
+    static constexpr quint64 PROGRESS_INTERVAL = 100;
+};
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <QHash>
+#include <QList>
+#include <QString>
+#include <QStringList>
+
+class CodeEditor;
+
+// Maps the files open in tabs to their editors.
+// Files are keyed by device and inode, so the same file reached through a
+// symlink or a relative path is found as well; files that don't exist on disk
+// yet fall back to their canonical path.
+class TabRegistry
+{
+public:
+    static QString canonical_path(const QString &file_name);
+
+    void add(CodeEditor *editor, const QString &file_name);
+    void remove(CodeEditor *editor);
+    // re-reads the inode of the editor's file after it was replaced on disk
+    void refresh(CodeEditor *editor);
+
+    CodeEditor *find(const QString &file_name) const;
+
+    bool contains(const QString &file_name) const {
+        return find(file_name) != nullptr;
+    }
+
+    // canonical paths of all registered files, for watchers and quick-open
+    QStringList paths() const;
+    QList<CodeEditor*> editors() const;
+
+private:
+    struct FileKey
+    {
+        quint64 device = 0;
+        quint64 inode = 0;
+
+        bool operator==(const FileKey &other) const {
+            return device == other.device && inode == other.inode;
+        }
+    };
+
+    friend size_t qHash(const FileKey &key, size_t seed) {
+        return qHashMulti(seed, key.device, key.inode);
+    }
+
+    struct Entry
+    {
+        QString path;
+        FileKey key; // zeroed if the file didn't exist when registered
+    };
+
+    static FileKey file_key(const QString &path);
+
+    QHash<CodeEditor*, Entry> entries;
+    QHash<FileKey, CodeEditor*> by_inode;
+    QHash<QString, CodeEditor*> by_path;
+};
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <QTreeWidget>
+
+#include "ds/testresult.hpp"
+
+// Per-test verdicts of the last test run, one row per test
+class TestPanel : public QTreeWidget
+{
+    Q_OBJECT
+public:
+    TestPanel(QWidget *parent = nullptr);
+
+    // one "Running" row per test
+    void reset(const QStringList &test_names);
+    void set_result(const TestResult &result);
+
+    // e.g. "3/4 passed"
+    QString summary() const;
+
+    static QString verdict_name(Verdict verdict);
+
+signals:
+    // a finished test was double-clicked
+    void diff_requested(int index);
+
+private:
+    enum Column { NAME, VERDICT, TIME, CPU, MEMORY, DETAILS };
+
+    int passed = 0;
+};
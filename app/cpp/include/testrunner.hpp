@@ -0,0 +1,58 @@
+#pragma once
+
+#include <QObject>
+#include <QThreadPool>
+#include <QVector>
+
+#include "ds/problem.hpp"
+#include "ds/testcase.hpp"
+#include "ds/testresult.hpp"
+
+// Runs a compiled solution against a set of stored tests.
+// Every test is a separate run on the thread pool, so they execute in
+// parallel across cores; results arrive in completion order. The output of
+// each run is written next to the test for the diff viewer.
+// Verdicts follow the judges: CPU time over the limit is TL, resident memory
+// over the limit is ML. The address space is capped at MEMORY_HEADROOM times
+// the limit rather than the limit itself, so the peak can still be measured
+// when a solution goes over it.
+class TestRunner : public QObject
+{
+    Q_OBJECT
+public:
+    TestRunner(QObject *parent = nullptr);
+    ~TestRunner();
+
+    bool is_running() const {
+        return remaining > 0;
+    }
+
+    // limits are the problem's, 0 means unlimited
+    void run(const QString &executable, const QString &working_directory,
+             const QVector<TestCase> &tests, const RunLimits &limits);
+
+    // time and memory limits of the problem, memory_limit is free text like "256 megabytes"
+    static RunLimits problem_limits(const Problem &problem);
+
+    // limits actually applied to the process when the problem has the given ones
+    static RunLimits process_limits(const RunLimits &limits);
+    static TestResult judge(int index, const RunResult &run, const QByteArray &expected, const RunLimits &limits);
+
+    // drops the pending runs, the ones already started finish unreported
+    void cancel();
+
+signals:
+    void test_finished(TestResult result);
+    void finished();
+
+private:
+    static constexpr qint64 MEMORY_HEADROOM = 2;
+    // programs waiting on something other than the CPU still get killed eventually
+    static constexpr qint64 DEFAULT_WALL_TIME_MS = 10000;
+
+    QThreadPool pool;
+
+    // bumped on every run, so results of a cancelled one are ignored
+    quint64 generation = 0;
+    int remaining = 0;
+};
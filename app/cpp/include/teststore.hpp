@@ -0,0 +1,48 @@
+#pragma once
+
+#include <QByteArray>
+#include <QString>
+#include <QVector>
+
+#include "ds/problem.hpp"
+#include "ds/testcase.hpp"
+
+// Tests of one problem kept on disk.
+// Every problem has a directory with numbered input/expected output pairs and
+// an index.json listing them; test data never has to be held in memory, the
+// runner reads and writes the files directly.
+class TestStore
+{
+public:
+    // key identifies the problem, e.g. its title or the source file when no problem is loaded
+    explicit TestStore(const QString &key);
+
+    static QString root();
+
+    QString directory() const {
+        return test_directory;
+    }
+
+    QVector<TestCase> tests() const;
+
+    // replaces the tests that came with the problem, keeps the ones added later
+    bool set_samples(const QVector<ProblemExample> &examples);
+    bool add(const QString &name, const QByteArray &input, const QByteArray &expected);
+
+private:
+    struct Entry
+    {
+        QString name;
+        QString stem; // file name without extension
+        bool sample;
+    };
+
+    QVector<Entry> read_index() const;
+    bool write_index(const QVector<Entry> &entries) const;
+
+    QString next_stem(const QVector<Entry> &entries) const;
+    bool write_file(const QString &file_name, const QByteArray &data) const;
+
+    QString key;
+    QString test_directory;
+};
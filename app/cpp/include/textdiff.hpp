@@ -0,0 +1,36 @@
+#pragma once
+
+#include <QString>
+#include <QVector>
+
+struct TextEdit
+{
+    int position; // in the original text
+    int removed;
+    QString text;
+};
+
+// Line-based diff used to turn one text into another with as few document
+// edits as possible.
+// Common leading and trailing lines are skipped, the rest is diffed with
+// Myers' O(ND) algorithm; if the texts differ in more than MAX_EDIT_LINES
+// lines the middle part is replaced as a whole.
+class TextDiff
+{
+public:
+    // edits are sorted by position and don't overlap, apply them back to front
+    static QVector<TextEdit> edits(const QString &before, const QString &after);
+
+private:
+    struct Hunk
+    {
+        int before_from, before_to;
+        int after_from, after_to;
+    };
+
+    static QVector<int> line_offsets(const QString &text);
+    static QVector<Hunk> diff_lines(const QString &before, const QVector<int> &before_lines,
+                                    const QString &after, const QVector<int> &after_lines);
+
+    static constexpr int MAX_EDIT_LINES = 1000;
+};
@@ -0,0 +1,152 @@
+#include "bufferjournal.hpp"
+
+#include <QRandomGenerator>
+#include <QTextCursor>
+#include <QTextDocument>
+#include <QTimer>
+
+#include "codeeditor.hpp"
+#include "journal.hpp"
+#include "journalwriter.hpp"
+
+BufferJournal::BufferJournal(CodeEditor *editor, JournalWriter *writer)
+    : QObject(editor), editor(editor), writer(writer)
+{
+    journal_id = QRandomGenerator::global()->generate64();
+
+    flush_timer = new QTimer(this);
+    flush_timer->setSingleShot(true);
+    flush_timer->setInterval(FLUSH_DELAY_MS);
+    connect(flush_timer, &QTimer::timeout, this, &BufferJournal::flush);
+
+    connect(editor->document(), &QTextDocument::contentsChange, this, &BufferJournal::contents_changed);
+    connect(editor->document(), &QTextDocument::modificationChanged, this, &BufferJournal::modification_changed);
+}
+
+BufferJournal::~BufferJournal() {
+    // closing a tab throws its edits away
+    discard();
+}
+
+void BufferJournal::adopt(quint64 id) {
+    discard();
+
+    // the old log may end with a torn record, so the next edit rewrites it
+    journal_id = id;
+    active = true;
+    needs_snapshot = true;
+}
+
+void BufferJournal::contents_changed(int position, int removed, int added) {
+    if (!is_tracking() || (!removed && !added)) {
+        return;
+    }
+
+    // the highlighter's markContentsDirty reports the block as replaced
+    // without touching the text, and only real edits bump the revision
+    QTextDocument *document = editor->document();
+    if (removed == added && document->revision() == revision) {
+        return;
+    }
+    revision = document->revision();
+
+    if (!active || needs_snapshot) {
+        write_snapshot();
+        return;
+    }
+
+    const int end = qMin(position + added, document->characterCount() - 1);
+
+    QTextCursor cursor(document);
+    cursor.setPosition(qMin(position, end));
+    cursor.setPosition(end, QTextCursor::KeepAnchor);
+
+    // same normalisation as QTextDocument::toPlainText
+    QString text = cursor.selectedText();
+    text.replace(QChar::ParagraphSeparator, '\n');
+    text.replace(QChar::LineSeparator, '\n');
+    text.replace(QChar::Nbsp, ' ');
+
+    pending += Journal::encode_delta(position, removed, text);
+
+    if (++records >= COMPACT_RECORDS) {
+        write_snapshot();
+        return;
+    }
+
+    if (!flush_timer->isActive()) {
+        flush_timer->start();
+    }
+}
+
+void BufferJournal::modification_changed(bool modified) {
+    if (!modified && is_tracking()) {
+        discard(); // saved, or undone back to the saved state
+    }
+}
+
+void BufferJournal::flush() {
+    if (pending.isEmpty()) {
+        return;
+    }
+
+    JournalWriter *writer = this->writer;
+    if (writer == nullptr) {
+        return;
+    }
+
+    const quint64 id = journal_id;
+    const QByteArray bytes = pending;
+    QMetaObject::invokeMethod(writer, [writer, id, bytes] () {
+        writer->append(id, bytes);
+    });
+
+    pending.clear();
+}
+
+void BufferJournal::write_snapshot() {
+    flush_timer->stop();
+    pending.clear();
+    records = 0;
+    active = true;
+    needs_snapshot = false;
+
+    JournalWriter *writer = this->writer;
+    if (writer == nullptr) {
+        return;
+    }
+
+    const quint64 id = journal_id;
+    const QByteArray bytes = Journal::encode_header(editor->get_file_name())
+                             + Journal::encode_snapshot(editor->toPlainText());
+    QMetaObject::invokeMethod(writer, [writer, id, bytes] () {
+        writer->replace(id, bytes);
+    });
+}
+
+void BufferJournal::discard() {
+    flush_timer->stop();
+    pending.clear();
+    records = 0;
+
+    if (!active) {
+        return;
+    }
+
+    active = false;
+
+    JournalWriter *writer = this->writer;
+    if (writer == nullptr) {
+        return;
+    }
+
+    const quint64 id = journal_id;
+    QMetaObject::invokeMethod(writer, [writer, id] () {
+        writer->discard(id);
+    });
+}
+
+bool BufferJournal::is_tracking() const {
+    // text swapped in by loading or tab virtualisation is not an edit
+    return !editor->is_loading() && !editor->is_unloaded() && !editor->is_large_file();
+}
@@ -0,0 +1,119 @@
+#include "buildcache.hpp"
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QRegularExpression>
+#include <QStandardPaths>
+
+QString BuildCache::directory() {
+    return QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/builds";
+}
+
+std::optional<QByteArray> BuildCache::key(const QString &source_file, const QString &compiler_path,
+                                          const QStringList &compiler_args) {
+    QFile source(source_file);
+    if (!source.open(QIODevice::ReadOnly)) {
+        return std::nullopt;
+    }
+
+    const QByteArray contents = source.readAll();
+
+    // only the source itself is hashed, so a change in a local header would go unnoticed
+    static const QRegularExpression local_include(R"(^\s*#\s*include\s*")", QRegularExpression::MultilineOption);
+    if (local_include.match(QString::fromUtf8(contents)).hasMatch()) {
+        return std::nullopt;
+    }
+
+    const QByteArray identity = compiler_identity(compiler_path);
+    if (identity.isEmpty()) {
+        return std::nullopt;
+    }
+
+    QCryptographicHash hash(QCryptographicHash::Sha256);
+    hash.addData(identity);
+    hash.addData(QByteArray(1, '\0'));
+    hash.addData(compiler_args.join(QChar('\0')).toUtf8());
+    hash.addData(QByteArray(1, '\0'));
+    hash.addData(contents);
+
+    return hash.result().toHex();
+}
+
+bool BuildCache::fetch(const QByteArray &key, const QString &output_file) {
+    const QString entry = entry_path(key);
+    if (!QFileInfo::exists(entry)) {
+        return false;
+    }
+
+    QFile::remove(output_file);
+    if (!QFile::copy(entry, output_file)) {
+        return false;
+    }
+
+    // the modification time doubles as the last use for eviction
+    QFile entry_file(entry);
+    if (entry_file.open(QIODevice::ReadWrite)) {
+        entry_file.setFileTime(QDateTime::currentDateTime(), QFileDevice::FileModificationTime);
+    }
+
+    return true;
+}
+
+void BuildCache::store(const QByteArray &key, const QString &output_file) {
+    if (!QDir().mkpath(directory())) {
+        return;
+    }
+
+    const QString entry = entry_path(key);
+    const QString temp = entry + ".tmp";
+
+    QFile::remove(temp);
+    if (!QFile::copy(output_file, temp)) {
+        return;
+    }
+
+    QFile::remove(entry);
+    if (!QFile::rename(temp, entry)) {
+        QFile::remove(temp);
+        return;
+    }
+
+    evict();
+}
+
+QString BuildCache::entry_path(const QByteArray &key) {
+    return directory() + '/' + QString::fromLatin1(key);
+}
+
+// an upgraded compiler changes its size or mtime, which invalidates everything
+// built by the previous one
+QByteArray BuildCache::compiler_identity(const QString &compiler_path) {
+    QString executable = compiler_path;
+    if (!executable.contains('/')) {
+        executable = QStandardPaths::findExecutable(compiler_path);
+    }
+
+    const QFileInfo info(QFileInfo(executable).canonicalFilePath());
+    if (!info.exists()) {
+        return {};
+    }
+
+    return (info.filePath() + '\0' + QString::number(info.size()) + '\0'
+            + QString::number(info.lastModified().toMSecsSinceEpoch())).toUtf8();
+}
+
+void BuildCache::evict() {
+    QFileInfoList entries = QDir(directory()).entryInfoList(QDir::Files, QDir::Time);
+
+    // newest first, so everything past the budget is the least recently used
+    qint64 total = 0;
+    for (const auto &entry : entries) {
+        total += entry.size();
+        if (total > MAX_SIZE) {
+            QFile::remove(entry.filePath());
+        }
+    }
+}
@@ -0,0 +1,212 @@
+#include "buildrunner.hpp"
+
+#include <QFile>
+#include <QSocketNotifier>
+#include <QStandardPaths>
+#include <QTimer>
+#include <QVector>
+
+#include <cerrno>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+BuildRunner::BuildRunner(QObject *parent)
+    : QObject(parent)
+{
+    reap_timer = new QTimer(this);
+    reap_timer->setInterval(REAP_INTERVAL_MS);
+    connect(reap_timer, &QTimer::timeout, this, &BuildRunner::check_exited);
+}
+
+BuildRunner::~BuildRunner() {
+    if (is_running()) {
+        ::kill(pid, SIGKILL);
+        ::waitpid(pid, nullptr, 0);
+    }
+
+    close_output();
+}
+
+void BuildRunner::start(BuildStep step, const QString &program, const QStringList &arguments,
+                        const QString &working_directory) {
+    if (is_running()) {
+        return;
+    }
+
+    this->step = step;
+
+    // the child can't search PATH safely after fork()
+    const QString executable = program.contains('/') ? program : QStandardPaths::findExecutable(program);
+    if (executable.isEmpty()) {
+        BuildResult result;
+        result.step = step;
+        result.error = "Can't find " + program;
+
+        emit finished(result);
+        return;
+    }
+
+    // everything the child touches is prepared before fork()
+    const QByteArray path = QFile::encodeName(executable);
+    const QByteArray directory = QFile::encodeName(working_directory);
+
+    QVector<QByteArray> encoded_arguments;
+    for (const auto &argument : arguments) {
+        encoded_arguments.push_back(argument.toLocal8Bit());
+    }
+
+    std::vector<char*> argv;
+    argv.push_back(const_cast<char*>(path.constData()));
+    for (const auto &argument : encoded_arguments) {
+        argv.push_back(const_cast<char*>(argument.constData()));
+    }
+    argv.push_back(nullptr);
+
+    int out_pipe[2], exec_pipe[2];
+    if (::pipe2(out_pipe, O_CLOEXEC) != 0) {
+        BuildResult result;
+        result.step = step;
+        result.error = qt_error_string(errno);
+
+        emit finished(result);
+        return;
+    }
+    if (::pipe2(exec_pipe, O_CLOEXEC) != 0) {
+        BuildResult result;
+        result.step = step;
+        result.error = qt_error_string(errno);
+        ::close(out_pipe[0]); ::close(out_pipe[1]);
+
+        emit finished(result);
+        return;
+    }
+
+    wall_timer.start();
+
+    const pid_t child = ::fork();
+    if (child == 0) {
+        // only async-signal-safe calls from here on; stdout and stderr are merged
+        const int null_fd = ::open("/dev/null", O_RDONLY | O_CLOEXEC);
+        ::dup2(null_fd, STDIN_FILENO);
+        ::dup2(out_pipe[1], STDOUT_FILENO);
+        ::dup2(out_pipe[1], STDERR_FILENO);
+
+        if (directory.isEmpty() || ::chdir(directory.constData()) == 0) {
+            ::execv(path.constData(), argv.data());
+        }
+
+        const int error = errno;
+        (void)!::write(exec_pipe[1], &error, sizeof(error));
+        ::_exit(127);
+    }
+
+    ::close(out_pipe[1]);
+    ::close(exec_pipe[1]);
+
+    // the exec pipe closes on a successful exec, so this returns right away
+    int exec_error = child < 0 ? errno : 0;
+    if (child > 0 && ::read(exec_pipe[0], &exec_error, sizeof(exec_error)) == sizeof(exec_error)) {
+        ::waitpid(child, nullptr, 0);
+    }
+    ::close(exec_pipe[0]);
+
+    if (exec_error != 0) {
+        ::close(out_pipe[0]);
+
+        BuildResult result;
+        result.step = step;
+        result.error = qt_error_string(exec_error);
+
+        emit finished(result);
+        return;
+    }
+
+    pid = child;
+    output_fd = out_pipe[0];
+    ::fcntl(output_fd, F_SETFL, O_NONBLOCK);
+
+    output_notifier = new QSocketNotifier(output_fd, QSocketNotifier::Read, this);
+    connect(output_notifier, &QSocketNotifier::activated, this, &BuildRunner::read_output);
+
+    reap_timer->start();
+}
+
+void BuildRunner::cancel() {
+    if (is_running()) {
+        ::kill(pid, SIGKILL);
+    }
+}
+
+void BuildRunner::read_output() {
+    if (output_fd < 0) {
+        return;
+    }
+
+    QByteArray data;
+    char chunk[64 * 1024];
+
+    for (;;) {
+        const ssize_t ret = ::read(output_fd, chunk, sizeof(chunk));
+        if (ret > 0) {
+            data.append(chunk, ret);
+            continue;
+        }
+
+        if (ret < 0 && errno == EINTR) {
+            continue;
+        }
+
+        // EOF: whoever held the pipe is gone
+        if (ret == 0 || errno != EAGAIN) {
+            close_output();
+        }
+        break;
+    }
+
+    if (!data.isEmpty()) {
+        emit output(data);
+    }
+}
+
+void BuildRunner::check_exited() {
+    int status = 0;
+    struct rusage usage = {};
+
+    const pid_t ret = ::wait4(pid, &status, WNOHANG, &usage);
+    if (ret == 0 || (ret < 0 && errno == EINTR)) {
+        return;
+    }
+
+    reap_timer->stop();
+    pid = -1;
+
+    // whatever the compiler printed last is already in the pipe
+    read_output();
+    close_output();
+
+    BuildResult result;
+    result.step = step;
+    result.started = true;
+    result.crashed = ret < 0 || WIFSIGNALED(status);
+    result.exit_code = ret > 0 && WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+    result.wall_time_ms = wall_timer.elapsed();
+    // includes the cc1plus, as and ld runs the driver waited for
+    result.cpu_time_ms = (usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1000
+                         + (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1000;
+
+    emit finished(result);
+}
+
+void BuildRunner::close_output() {
+    delete output_notifier;
+    output_notifier = nullptr;
+
+    if (output_fd >= 0) {
+        ::close(output_fd);
+        output_fd = -1;
+    }
+}
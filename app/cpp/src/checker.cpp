@@ -0,0 +1,159 @@
+#include "checker.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <string>
+
+namespace {
+
+class Tokenizer
+{
+public:
+    Tokenizer(const QByteArray &bytes)
+        : cur(bytes.constData()), end(bytes.constData() + bytes.size()) {}
+
+    // false once the input is exhausted
+    bool next(const char *&token, qsizetype &length) {
+        while (cur < end && std::isspace(static_cast<unsigned char>(*cur))) {
+            ++cur;
+        }
+
+        if (cur == end) {
+            return false;
+        }
+
+        token = cur;
+        while (cur < end && !std::isspace(static_cast<unsigned char>(*cur))) {
+            ++cur;
+        }
+        length = cur - token;
+
+        return true;
+    }
+
+private:
+    const char *cur;
+    const char *end;
+};
+
+// only plain decimal numbers count, strtod alone would also take hex, inf and nan
+bool parse_number(const char *token, qsizetype length, bool &real, double &value) {
+    const auto is_digit = [] (char c) {
+        return c >= '0' && c <= '9';
+    };
+
+    const char *cur = token;
+    const char *end = token + length;
+    real = false;
+
+    if (cur < end && (*cur == '+' || *cur == '-')) {
+        ++cur;
+    }
+
+    const char *digits = cur;
+    while (cur < end && is_digit(*cur)) {
+        ++cur;
+    }
+    qsizetype digit_count = cur - digits;
+
+    if (cur < end && *cur == '.') {
+        real = true;
+        const char *fraction = ++cur;
+        while (cur < end && is_digit(*cur)) {
+            ++cur;
+        }
+        digit_count += cur - fraction;
+    }
+
+    if (digit_count == 0) {
+        return false;
+    }
+
+    if (cur < end && (*cur == 'e' || *cur == 'E')) {
+        real = true;
+        if (++cur < end && (*cur == '+' || *cur == '-')) {
+            ++cur;
+        }
+
+        const char *exponent = cur;
+        while (cur < end && is_digit(*cur)) {
+            ++cur;
+        }
+        if (cur == exponent) {
+            return false;
+        }
+    }
+
+    if (cur != end) {
+        return false;
+    }
+
+    const std::string text(token, length);
+    value = std::strtod(text.c_str(), nullptr);
+
+    return std::isfinite(value);
+}
+
+QString quote(const char *token, qsizetype length) {
+    static constexpr qsizetype MAX_QUOTE = 32;
+
+    QString text = QString::fromUtf8(token, qMin(length, MAX_QUOTE));
+    if (length > MAX_QUOTE) {
+        text += "...";
+    }
+
+    return '"' + text + '"';
+}
+
+}
+
+CheckResult Checker::compare(const QByteArray &output, const QByteArray &expected) {
+    Tokenizer output_tokens(output);
+    Tokenizer expected_tokens(expected);
+
+    CheckResult result;
+
+    for (qint64 index = 1; ; ++index) {
+        const char *got = nullptr, *want = nullptr;
+        qsizetype got_length = 0, want_length = 0;
+
+        const bool has_got = output_tokens.next(got, got_length);
+        const bool has_want = expected_tokens.next(want, want_length);
+
+        if (!has_got && !has_want) {
+            result.ok = true;
+            return result;
+        }
+
+        if (!has_got) {
+            result.message = "token " + QString::number(index) + ": expected " + quote(want, want_length) + ", output ended";
+            return result;
+        }
+
+        if (!has_want) {
+            result.message = "token " + QString::number(index) + ": extra output " + quote(got, got_length);
+            return result;
+        }
+
+        if (got_length == want_length && std::equal(got, got + got_length, want)) {
+            continue;
+        }
+
+        // integers on both sides are compared exactly, they may not even fit in a double
+        bool got_real, want_real;
+        double got_value, want_value;
+        if (parse_number(got, got_length, got_real, got_value) && parse_number(want, want_length, want_real, want_value)
+            && (got_real || want_real)) {
+            const double error = std::abs(got_value - want_value);
+            if (error <= EPSILON || error <= EPSILON * std::abs(want_value)) {
+                continue;
+            }
+        }
+
+        result.message = "token " + QString::number(index) + ": expected " + quote(want, want_length)
+                         + ", got " + quote(got, got_length);
+        return result;
+    }
+}
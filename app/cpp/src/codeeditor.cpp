@@ -7,6 +7,17 @@
 #include <QFileDialog>
 #include <QMessageBox>
 #include <QDebug>
+#include <QScrollBar>
+#include <QSignalBlocker>
+#include <QTextLayout>
+#include <QtMath>
+#include <QHelpEvent>
+#include <QToolTip>
+
+#include "piecetable.hpp"
+#include "qsourcehighliter.h"
+#include "smartindent.hpp"
+#include "textdiff.hpp"
 
 //![constructor]
 
@@ -19,8 +30,22 @@ CodeEditor::CodeEditor(QWidget *parent) : QPlainTextEdit(parent)
     connect(this, &CodeEditor::blockCountChanged, this, &CodeEditor::updateLineNumberAreaWidth);
     connect(this, &CodeEditor::updateRequest, this, &CodeEditor::updateLineNumberArea);
     connect(this, &CodeEditor::cursorPositionChanged, this, &CodeEditor::highlightCurrentLine);
+    connect(this, &CodeEditor::cursorPositionChanged, this, &CodeEditor::highlight_matching_bracket);
 
+    connect(document(), &QTextDocument::contentsChange, this, [this] (int, int chars_removed, int chars_added) {
+        if (piece_table != nullptr && (chars_removed || chars_added)) {
+            window_dirty = true;
+            ++large_file_edits;
+        }
+    });
 
+    connect(this, &CodeEditor::blockCountChanged, this, [this] () {
+        // unloading and loading swap the contents without editing them
+        if (!line_heat.isEmpty() && !unloaded && !loading) {
+            line_heat.clear();
+            lineNumberArea->update();
+        }
+    });
 
     updateLineNumberAreaWidth(0);
     highlightCurrentLine();
@@ -28,20 +53,428 @@ CodeEditor::CodeEditor(QWidget *parent) : QPlainTextEdit(parent)
 
 //![constructor]
 
+CodeEditor::~CodeEditor()
+{
+    delete piece_table;
+}
+
+void CodeEditor::set_loading(bool loading)
+{
+    this->loading = loading;
+
+    setReadOnly(loading);
+    setUndoRedoEnabled(!loading);
+    highlightCurrentLine();
+}
+
+void CodeEditor::setup_highlighter()
+{
+    if (highlighter != nullptr) {
+        return;
+    }
+
+    highlighter = new QSourceHighlite::QSourceHighliter(document());
+    highlighter->setCurrentLanguage(QSourceHighlite::QSourceHighliter::CodeCpp); //TODO: determine language by extension
+}
+
+void CodeEditor::unload()
+{
+    if (unloaded || loading || is_large_file()) {
+        return;
+    }
+
+    saved_cursor_position = textCursor().position();
+    saved_scroll_position = verticalScrollBar()->value();
+    saved_modified = document()->isModified();
+
+    // unmodified files are simply re-read on activation
+    if (saved_modified || !file_name.has_value()) {
+        unloaded_buffer = qCompress(toPlainText().toUtf8());
+    } else {
+        unloaded_buffer.reset();
+    }
+
+    // set first so document signals from the swap are not taken for edits
+    unloaded = true;
+
+    delete highlighter;
+    highlighter = nullptr;
+
+    {
+        const QSignalBlocker blocker(this);
+        setPlainText(QString());
+    }
+    document()->setModified(saved_modified); // keeps the close prompt working
+
+    compressed_cache.clear();
+    compressed_cache_revision = -1;
+}
+
+void CodeEditor::restore_from_buffer()
+{
+    if (!unloaded) {
+        return;
+    }
+
+    setup_highlighter();
+
+    if (unloaded_buffer.has_value()) {
+        const QSignalBlocker blocker(this);
+        setPlainText(QString::fromUtf8(qUncompress(unloaded_buffer.value())));
+    }
+    unloaded_buffer.reset();
+
+    document()->setModified(saved_modified);
+    restore_view_state();
+}
+
+void CodeEditor::restore_view_state()
+{
+    unloaded = false;
+
+    QTextCursor cursor = textCursor();
+    cursor.setPosition(qMin(saved_cursor_position, document()->characterCount() - 1));
+    setTextCursor(cursor);
+
+    verticalScrollBar()->setValue(saved_scroll_position);
+
+    // the squiggles were dropped along with the contents
+    apply_diagnostics();
+}
+
+void CodeEditor::set_diagnostics(const QVector<Diagnostic> &diagnostics)
+{
+    this->diagnostics = diagnostics;
+
+    if (!unloaded) {
+        apply_diagnostics();
+    }
+}
+
+void CodeEditor::apply_diagnostics()
+{
+    QList<QTextEdit::ExtraSelection> selections;
+    squiggle_messages.clear();
+
+    // line numbers of a large file are relative to a window that keeps sliding
+    if (is_large_file()) {
+        setExtraSelections(selections);
+        return;
+    }
+
+    for (const auto &diagnostic : diagnostics) {
+        if (diagnostic.severity == DiagnosticSeverity::NOTE) {
+            continue;
+        }
+
+        const QTextBlock block = document()->findBlockByNumber(diagnostic.line - 1);
+        if (!block.isValid()) {
+            continue;
+        }
+
+        QTextCursor cursor(block);
+        if (diagnostic.column > 0) {
+            cursor.setPosition(diagnostic_position(block, diagnostic.column));
+            cursor.movePosition(QTextCursor::EndOfWord, QTextCursor::KeepAnchor);
+
+            // e.g. a missing semicolon is reported at a punctuation character
+            if (!cursor.hasSelection()) {
+                cursor.movePosition(QTextCursor::Right, QTextCursor::KeepAnchor);
+            }
+        } else {
+            cursor.setPosition(block.position() + SmartIndent::leading_whitespace(block.text()).size());
+            cursor.movePosition(QTextCursor::EndOfBlock, QTextCursor::KeepAnchor);
+        }
+
+        QTextEdit::ExtraSelection selection;
+        selection.cursor = cursor;
+        selection.format.setUnderlineStyle(QTextCharFormat::SpellCheckUnderline);
+        selection.format.setUnderlineColor(diagnostic.severity == DiagnosticSeverity::ERROR ? Qt::red : QColor(0xd0, 0xa0, 0x00));
+
+        selections.push_back(selection);
+        squiggle_messages.push_back(diagnostic.message);
+    }
+
+    setExtraSelections(selections);
+}
+
+int CodeEditor::diagnostic_position(const QTextBlock &block, int column) const
+{
+    // GCC counts display columns, with tabs stopping every 8 columns
+    static constexpr int COMPILER_TAB_STOP = 8;
+
+    const QString text = block.text();
+
+    int display_column = 1;
+    int index = 0;
+    for (; index < text.size() && display_column < column; ++index) {
+        display_column = text[index] == '\t'
+            ? display_column + COMPILER_TAB_STOP - (display_column - 1) % COMPILER_TAB_STOP
+            : display_column + 1;
+    }
+
+    return block.position() + index;
+}
+
+void CodeEditor::set_line_heat(const QHash<int, double> &heat)
+{
+    // line numbers of a large file are relative to the loaded window
+    line_heat = is_large_file() ? QHash<int, double>() : heat;
+    lineNumberArea->update();
+}
+
+void CodeEditor::go_to(int line, int column)
+{
+    const QTextBlock block = document()->findBlockByNumber(qMax(line, 1) - 1);
+    if (!block.isValid()) {
+        return;
+    }
+
+    QTextCursor cursor(block);
+    if (column > 0) {
+        cursor.setPosition(diagnostic_position(block, column));
+    }
+
+    setTextCursor(cursor);
+    centerCursor();
+    setFocus();
+}
+
+qint64 CodeEditor::memory_estimate() const
+{
+    // utf-16 text plus layout and highlighter formats, a rough upper bound
+    static constexpr qint64 BYTES_PER_CHAR = 16;
+
+    return unloaded ? 0 : qint64(document()->characterCount()) * BYTES_PER_CHAR;
+}
+
+void CodeEditor::replace_contents(const QString &text)
+{
+    const QVector<TextEdit> edits = TextDiff::edits(toPlainText(), text);
+    if (edits.isEmpty()) {
+        return;
+    }
+
+    // one edit block, undone as a single step
+    QTextCursor cursor(document());
+    cursor.beginEditBlock();
+
+    for (auto it = edits.crbegin(); it != edits.crend(); ++it) {
+        cursor.setPosition(it->position);
+        cursor.setPosition(it->position + it->removed, QTextCursor::KeepAnchor);
+        cursor.insertText(it->text);
+    }
+
+    cursor.endEditBlock();
+}
+
+int CodeEditor::cursor_position() const
+{
+    return unloaded ? saved_cursor_position : textCursor().position();
+}
+
+int CodeEditor::scroll_position() const
+{
+    return unloaded ? saved_scroll_position : verticalScrollBar()->value();
+}
+
+QByteArray CodeEditor::compressed_contents()
+{
+    if (unloaded) {
+        return unloaded_buffer.value_or(QByteArray());
+    }
+
+    const int revision = document()->revision();
+    if (revision != compressed_cache_revision) {
+        compressed_cache = qCompress(toPlainText().toUtf8());
+        compressed_cache_revision = revision;
+    }
+
+    return compressed_cache;
+}
+
+void CodeEditor::restore_unloaded(int cursor_position, int scroll_position, bool modified,
+                                  const std::optional<QByteArray> &buffer)
+{
+    if (loading || is_large_file()) {
+        return;
+    }
+
+    unloaded = true;
+
+    delete highlighter;
+    highlighter = nullptr;
+
+    {
+        const QSignalBlocker blocker(this);
+        setPlainText(QString());
+    }
+
+    saved_cursor_position = cursor_position;
+    saved_scroll_position = scroll_position;
+    saved_modified = modified;
+    unloaded_buffer = buffer;
+
+    document()->setModified(modified);
+
+    compressed_cache.clear();
+    compressed_cache_revision = -1;
+}
+
+bool CodeEditor::open_large_file(const QString &file_name, bool read_only)
+{
+    auto file = std::make_shared<QFile>(file_name);
+
+    if (!file->open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    // the mapping stays valid for as long as the file is open
+    const qint64 size = file->size();
+    uchar *data = size ? file->map(0, size) : nullptr;
+    if (size && data == nullptr) {
+        return false;
+    }
+
+    delete piece_table;
+    piece_table = new PieceTable(reinterpret_cast<const char*>(data), size, file);
+
+    setLineWrapMode(QPlainTextEdit::NoWrap);
+    setReadOnly(read_only);
+
+    connect(verticalScrollBar(), &QScrollBar::valueChanged, this, &CodeEditor::slide_window, Qt::UniqueConnection);
+
+    load_window(0);
+
+    set_file_name(file_name);
+    document()->setModified(false);
+    highlightCurrentLine();
+
+    return true;
+}
+
+PieceTable CodeEditor::large_file_snapshot()
+{
+    commit_window();
+    return *piece_table;
+}
+
+int CodeEditor::save_revision() const
+{
+    return is_large_file() ? large_file_edits : document()->revision();
+}
+
+qint64 CodeEditor::window_begin() const
+{
+    return piece_table->line_offset(window_first_line);
+}
+
+qint64 CodeEditor::window_end() const
+{
+    const qint64 next_line = window_first_line + window_line_count;
+
+    if (next_line >= piece_table->line_count()) {
+        return piece_table->size();
+    }
+
+    return piece_table->line_offset(next_line) - 1; // the newline ending the window is not paged in
+}
+
+void CodeEditor::load_window(qint64 first_line)
+{
+    commit_window();
+
+    const qint64 line_count = piece_table->line_count();
+    first_line = qBound<qint64>(0, first_line, qMax<qint64>(0, line_count - LARGE_FILE_WINDOW_LINES));
+
+    window_first_line = first_line;
+    window_line_count = qMin(LARGE_FILE_WINDOW_LINES, line_count - first_line);
+
+    const qint64 begin = window_begin();
+    const QByteArray bytes = piece_table->read(begin, window_end() - begin);
+
+    const bool modified = document()->isModified();
+    const int edits = large_file_edits;
+    {
+        const QSignalBlocker blocker(this); // paging is not an edit
+        setPlainText(QString::fromUtf8(bytes));
+    }
+    document()->setModified(modified);
+    large_file_edits = edits;
+    window_dirty = false;
+
+    updateLineNumberAreaWidth(0);
+    lineNumberArea->update();
+}
+
+void CodeEditor::commit_window()
+{
+    if (piece_table == nullptr || !window_dirty) {
+        return;
+    }
+
+    const qint64 begin = window_begin();
+    piece_table->remove(begin, window_end() - begin);
+    piece_table->insert(begin, toPlainText().toUtf8());
+
+    window_line_count = blockCount();
+    window_dirty = false;
+}
+
+void CodeEditor::slide_window()
+{
+    if (piece_table == nullptr || window_sliding) {
+        return;
+    }
+
+    const int first_visible = firstVisibleBlock().blockNumber();
+    const bool near_top = first_visible < LARGE_FILE_WINDOW_MARGIN && window_first_line > 0;
+    const bool near_bottom = blockCount() - first_visible < LARGE_FILE_WINDOW_MARGIN
+        && window_first_line + blockCount() < piece_table->line_count();
+
+    if (!near_top && !near_bottom) {
+        return;
+    }
+
+    window_sliding = true;
+
+    const qint64 anchor_line = window_first_line + first_visible;
+    const QTextCursor cursor = textCursor();
+    const qint64 cursor_line = window_first_line + cursor.blockNumber();
+    const int cursor_column = cursor.positionInBlock();
+
+    load_window(anchor_line - LARGE_FILE_WINDOW_LINES / 2);
+
+    if (cursor_line >= window_first_line && cursor_line < window_first_line + window_line_count) {
+        const QTextBlock block = document()->findBlockByNumber(cursor_line - window_first_line);
+        QTextCursor new_cursor(block);
+        new_cursor.setPosition(block.position() + qMin(cursor_column, block.length() - 1));
+        setTextCursor(new_cursor);
+    }
+
+    verticalScrollBar()->setValue(anchor_line - window_first_line);
+
+    window_sliding = false;
+}
+
 //![extraAreaWidth]
 
 int CodeEditor::lineNumberAreaWidth()
 {
     int digits = 1;
-    int max = qMax(1, blockCount());
+    qint64 max = qMax<qint64>(1, piece_table ? piece_table->line_count() : blockCount());
     while (max >= 10) {
         max /= 10;
         ++digits;
     }
 
-    int space = 3 + fontMetrics().horizontalAdvance(QLatin1Char('9')) * digits;
+    // font metrics are only consulted when the digit count changes
+    if (digits != line_number_digits) {
+        line_number_digits = digits;
+        line_number_width = 3 + fontMetrics().horizontalAdvance(QLatin1Char('9')) * digits;
+    }
 
-    return space;
+    return line_number_width;
 }
 
 //![extraAreaWidth]
@@ -50,7 +483,15 @@ int CodeEditor::lineNumberAreaWidth()
 
 void CodeEditor::updateLineNumberAreaWidth(int /* newBlockCount */)
 {
-    setViewportMargins(lineNumberAreaWidth(), 0, 0, 0);
+    const int width = lineNumberAreaWidth();
+    if (width == viewportMargins().left()) {
+        return;
+    }
+
+    setViewportMargins(width, 0, 0, 0);
+
+    QRect cr = contentsRect();
+    lineNumberArea->setGeometry(QRect(cr.left(), cr.top(), width, cr.height()));
 }
 //![slotUpdateExtraAreaWidth]
 
@@ -77,10 +518,56 @@ void CodeEditor::resizeEvent(QResizeEvent *e)
     lineNumberArea->setGeometry(QRect(cr.left(), cr.top(), lineNumberAreaWidth(), cr.height()));
 }
 
+void CodeEditor::changeEvent(QEvent *event)
+{
+    QPlainTextEdit::changeEvent(event);
+
+    if (event->type() == QEvent::FontChange && lineNumberArea != nullptr) {
+        digit_pixmaps.clear();
+        line_number_digits = 0;
+        updateLineNumberAreaWidth(0);
+        lineNumberArea->update();
+    }
+}
+
+bool CodeEditor::viewportEvent(QEvent *event) {
+    if (event->type() != QEvent::ToolTip) {
+        return QPlainTextEdit::viewportEvent(event);
+    }
+
+    const QHelpEvent *help_event = static_cast<QHelpEvent*>(event);
+    const int position = cursorForPosition(help_event->pos()).position();
+
+    QStringList messages;
+    const QList<QTextEdit::ExtraSelection> selections = extraSelections();
+    for (int i = 0; i < selections.size() && i < squiggle_messages.size(); ++i) {
+        const QTextCursor &cursor = selections[i].cursor;
+        if (cursor.selectionStart() <= position && position < cursor.selectionEnd()) {
+            messages << squiggle_messages[i];
+        }
+    }
+
+    if (messages.isEmpty()) {
+        QToolTip::hideText();
+        event->ignore();
+    } else {
+        QToolTip::showText(help_event->globalPos(), messages.join('\n'), viewport());
+    }
+
+    return true;
+}
+
 void CodeEditor::keyPressEvent(QKeyEvent *event) {
+    if (!isReadOnly() && event->text() == "}") {
+        dedent_closing_brace();
+    }
+
     QPlainTextEdit::keyPressEvent(event);
 
-    if (event->key() == Qt::Key_Return) {
+    // Shift+Return breaks the line with U+2028 inside the same block,
+    // while smart indent works on the block the line break started
+    if (!isReadOnly() && (event->key() == Qt::Key_Return || event->key() == Qt::Key_Enter)
+        && !(event->modifiers() & Qt::ShiftModifier)) {
         add_leading_offset();
     }
 }
@@ -90,26 +577,198 @@ void CodeEditor::keyPressEvent(QKeyEvent *event) {
 
 void CodeEditor::highlightCurrentLine()
 {
-    QList<QTextEdit::ExtraSelection> extraSelections;
+    if (isReadOnly()) {
+        clear_highlight(HighlightSlot::CURRENT_LINE);
+        return;
+    }
 
-    if (!isReadOnly()) {
-        QTextEdit::ExtraSelection selection;
+    QTextCursor cursor = textCursor();
+    cursor.clearSelection();
+
+    set_highlight(HighlightSlot::CURRENT_LINE, cursor, palette().alternateBase().color(), true);
+}
+
+//![cursorPositionChanged]
+
+void CodeEditor::highlight_matching_bracket()
+{
+    static const QString brackets = "()[]{}";
+
+    int pos = textCursor().position();
+    if (!brackets.contains(document()->characterAt(pos))) {
+        --pos; // bracket right before the cursor
+    }
+
+    const int match = brackets.contains(document()->characterAt(pos)) ? find_matching_bracket(pos) : -1;
+
+    if (match == -1) {
+        clear_highlight(HighlightSlot::BRACKET_OPEN);
+        clear_highlight(HighlightSlot::BRACKET_CLOSE);
+        return;
+    }
+
+    const QColor color(180, 230, 180);
+
+    QTextCursor bracket(document());
+    bracket.setPosition(qMin(pos, match));
+    bracket.movePosition(QTextCursor::NextCharacter, QTextCursor::KeepAnchor);
+    set_highlight(HighlightSlot::BRACKET_OPEN, bracket, color, false);
+
+    bracket.setPosition(qMax(pos, match));
+    bracket.movePosition(QTextCursor::NextCharacter, QTextCursor::KeepAnchor);
+    set_highlight(HighlightSlot::BRACKET_CLOSE, bracket, color, false);
+}
 
-        selection.format.setProperty(QTextFormat::FullWidthSelection, true);
-        selection.cursor = textCursor();
-        selection.cursor.clearSelection();
-        extraSelections.append(selection);
+int CodeEditor::find_matching_bracket(int pos) const
+{
+    static const QString open_brackets = "([{";
+    static const QString close_brackets = ")]}";
+
+    const QChar bracket = document()->characterAt(pos);
+
+    int kind = open_brackets.indexOf(bracket);
+    int direction = 1;
+    QChar match;
+
+    if (kind != -1) {
+        match = close_brackets[kind];
+    } else {
+        kind = close_brackets.indexOf(bracket);
+        direction = -1;
+        match = open_brackets[kind];
     }
 
-    setExtraSelections(extraSelections);
+    // bounded, so huge unbalanced files never stall cursor movement
+    int depth = 0;
+    for (int i = 0; i < MAX_BRACKET_SCAN; ++i) {
+        pos += direction;
+
+        const QChar ch = document()->characterAt(pos);
+        if (ch.isNull()) {
+            return -1;
+        }
+
+        if (ch == bracket) {
+            ++depth;
+        } else if (ch == match) {
+            if (!depth) {
+                return pos;
+            }
+            --depth;
+        }
+    }
+
+    return -1;
 }
 
-//![cursorPositionChanged]
+void CodeEditor::set_highlight(HighlightSlot slot, const QTextCursor &cursor, const QColor &color, bool full_width)
+{
+    const PaintedHighlight old_highlight = highlights.value(slot);
+    const QRect old_rect = highlight_rect(old_highlight);
+
+    const PaintedHighlight new_highlight = {cursor, color, full_width};
+    const QRect new_rect = highlight_rect(new_highlight);
+
+    highlights[slot] = new_highlight;
+
+    // e.g. the cursor moved inside the same line
+    if (old_rect == new_rect && old_highlight.color == color) {
+        return;
+    }
+
+    viewport()->update(old_rect);
+    viewport()->update(new_rect);
+}
+
+void CodeEditor::clear_highlight(HighlightSlot slot)
+{
+    if (!highlights.contains(slot)) {
+        return;
+    }
+
+    viewport()->update(highlight_rect(highlights.take(slot)));
+}
+
+QRect CodeEditor::highlight_rect(const PaintedHighlight &highlight) const
+{
+    if (highlight.cursor.isNull()) {
+        return QRect();
+    }
+
+    if (!highlight.full_width) {
+        QTextCursor begin = highlight.cursor;
+        begin.setPosition(highlight.cursor.selectionStart());
+        QTextCursor end = highlight.cursor;
+        end.setPosition(highlight.cursor.selectionEnd());
+
+        const QRect begin_rect = cursorRect(begin);
+        return QRect(begin_rect.topLeft(), QPoint(cursorRect(end).left(), begin_rect.bottom()));
+    }
+
+    const QTextBlock block = highlight.cursor.block();
+    if (!block.isValid() || !block.isVisible()) {
+        return QRect();
+    }
+
+    QRectF rect = blockBoundingGeometry(block).translated(contentOffset());
+
+    // only the visual line holding the cursor when the block is wrapped
+    const QTextLine line = block.layout()->lineForTextPosition(highlight.cursor.positionInBlock());
+    if (line.isValid()) {
+        rect = QRectF(rect.left(), rect.top() + line.y(), rect.width(), line.height());
+    }
+
+    return QRect(0, qFloor(rect.top()), viewport()->width(), qCeil(rect.height()));
+}
+
+void CodeEditor::paintEvent(QPaintEvent *event)
+{
+    {
+        QPainter painter(viewport());
+
+        for (const auto &highlight : highlights) {
+            const QRect rect = highlight_rect(highlight);
+            if (rect.intersects(event->rect())) {
+                painter.fillRect(rect, highlight.color);
+            }
+        }
+    }
+
+    QPlainTextEdit::paintEvent(event);
+}
 
 //![extraAreaPaintEvent_0]
 
+void CodeEditor::render_digit_pixmaps()
+{
+    const qreal ratio = lineNumberArea->devicePixelRatioF();
+    const QFontMetrics metrics = fontMetrics();
+
+    digit_width = metrics.horizontalAdvance(QLatin1Char('9'));
+    digit_pixmaps.clear();
+
+    for (char digit = '0'; digit <= '9'; ++digit) {
+        QPixmap pixmap(QSize(digit_width, metrics.height()) * ratio);
+        pixmap.setDevicePixelRatio(ratio);
+        pixmap.fill(Qt::transparent);
+
+        QPainter painter(&pixmap);
+        painter.setFont(font());
+        painter.setPen(Qt::black);
+        painter.drawText(QRect(0, 0, digit_width, metrics.height()), Qt::AlignRight, QString(QLatin1Char(digit)));
+
+        digit_pixmaps.push_back(pixmap);
+    }
+
+    digit_pixmaps_ratio = ratio;
+}
+
 void CodeEditor::lineNumberAreaPaintEvent(QPaintEvent *event)
 {
+    if (digit_pixmaps.isEmpty() || digit_pixmaps_ratio != lineNumberArea->devicePixelRatioF()) {
+        render_digit_pixmaps();
+    }
+
     QPainter painter(lineNumberArea);
     painter.fillRect(event->rect(), Qt::lightGray);
 
@@ -117,7 +776,7 @@ void CodeEditor::lineNumberAreaPaintEvent(QPaintEvent *event)
 
 //![extraAreaPaintEvent_1]
     QTextBlock block = firstVisibleBlock();
-    int blockNumber = block.blockNumber();
+    qint64 blockNumber = window_first_line + block.blockNumber();
     int top = qRound(blockBoundingGeometry(block).translated(contentOffset()).top());
     int bottom = top + qRound(blockBoundingRect(block).height());
 //![extraAreaPaintEvent_1]
@@ -125,10 +784,20 @@ void CodeEditor::lineNumberAreaPaintEvent(QPaintEvent *event)
 //![extraAreaPaintEvent_2]
     while (block.isValid() && top <= event->rect().bottom()) {
         if (block.isVisible() && bottom >= event->rect().top()) {
-            QString number = QString::number(blockNumber + 1);
-            painter.setPen(Qt::black);
-            painter.drawText(0, top, lineNumberArea->width(), fontMetrics().height(),
-                             Qt::AlignRight, number);
+            const double heat = line_heat.value(int(blockNumber) + 1);
+            if (heat > 0) {
+                static constexpr int MIN_HEAT_ALPHA = 40;
+                static constexpr int MAX_HEAT_ALPHA = 220;
+                painter.fillRect(0, top, lineNumberArea->width(), bottom - top,
+                                 QColor(255, 64, 0, MIN_HEAT_ALPHA + qRound(heat * (MAX_HEAT_ALPHA - MIN_HEAT_ALPHA))));
+            }
+
+            // numbers are blitted right to left from the pre-rendered digits
+            int x = lineNumberArea->width();
+            for (qint64 number = blockNumber + 1; number; number /= 10) {
+                x -= digit_width;
+                painter.drawPixmap(x, top, digit_pixmaps[number % 10]);
+            }
         }
 
         block = block.next();
@@ -140,61 +809,65 @@ void CodeEditor::lineNumberAreaPaintEvent(QPaintEvent *event)
 //![extraAreaPaintEvent_2]
 
 void CodeEditor::add_leading_offset() {
-    QString editor_text = this->toPlainText();
+    QTextCursor cursor = textCursor();
+    const QTextBlock prev_block = cursor.block().previous();
 
-    const int start_cursor_pos = this->textCursor().position();
-    const int line_end = start_cursor_pos - 2;
-    int line_begin;
+    if (!prev_block.isValid()) {
+        return;
+    }
 
-    for (line_begin = line_end; line_begin >= 0 && editor_text[line_begin] != '\n'; --line_begin);
+    const QString prev_code = SmartIndent::code(prev_block.text());
+    const bool opens_brace = !prev_code.isEmpty() && prev_code.back() == '{';
 
-    if (line_begin >= 0) { // if we found the end of the previous line
-        ++line_begin;
-    } else { // if we didn't found it, than we are on the first line;
-        line_begin = 0;
-    }
+    QString offset = SmartIndent::indent_after(prev_block);
 
-    const QString line = editor_text.mid(line_begin, start_cursor_pos - line_begin - 1);
+    // text that was moved to the new line by the line break
+    const QString rest = cursor.block().text();
+    const QString rest_ws = SmartIndent::leading_whitespace(rest);
+    const bool rest_closes = rest.mid(rest_ws.size()).startsWith('}');
 
-    if (line.isEmpty()) {
-        return;
+    if (rest_closes && !opens_brace) {
+        offset = SmartIndent::dedent(offset);
     }
 
+    // the line break and the indentation are undone together
+    cursor.joinPreviousEditBlock();
 
+    cursor.movePosition(QTextCursor::StartOfBlock);
+    cursor.movePosition(QTextCursor::Right, QTextCursor::KeepAnchor, rest_ws.size());
+    cursor.insertText(offset);
 
-    QString offset;
-    for (const auto &ch : line) {
-        switch (ch.toLatin1()) {
-            case ' ':
-            case '\t':
-                offset += ch;
-            break;
-            default:
-                goto end;
-            break;
-        }
-    }
+    if (opens_brace && (rest_closes || rest.size() == rest_ws.size())) {
+        const int inner_pos = cursor.position();
+        const QString closing_offset = SmartIndent::leading_whitespace(prev_block.text());
 
-    end:
-    if (line.back() == '{') {
-        offset += '\t';
-    }
+        cursor.insertText('\n' + closing_offset);
+        if (!rest_closes) {
+            cursor.insertText(QString('}'));
+        }
 
-    if (!offset.isEmpty()) {
-        insertPlainText(offset);
+        cursor.setPosition(inner_pos);
     }
 
-    if (line.back() == '{') {
-        if (offset.back() == '\t') {
-            offset.chop(1);
-        }
+    cursor.endEditBlock();
 
-        insertPlainText('\n' + offset + '}');
+    setTextCursor(cursor);
+}
 
-        QTextCursor temp_cursor = this->textCursor();
-        temp_cursor.setPosition(start_cursor_pos);
-        setTextCursor(temp_cursor);
+void CodeEditor::dedent_closing_brace() {
+    QTextCursor cursor = textCursor();
+    const QString before_cursor = cursor.block().text().left(cursor.positionInBlock());
 
-        this->moveCursor(QTextCursor::EndOfLine);
+    // only when the brace is the first character typed on the line
+    if (before_cursor.isEmpty() || SmartIndent::leading_whitespace(before_cursor) != before_cursor) {
+        return;
     }
-} 
\ No newline at end of file
+
+    cursor.beginEditBlock();
+    cursor.movePosition(QTextCursor::StartOfBlock);
+    cursor.movePosition(QTextCursor::Right, QTextCursor::KeepAnchor, before_cursor.size());
+    cursor.insertText(SmartIndent::dedent(before_cursor));
+    cursor.endEditBlock();
+
+    setTextCursor(cursor);
+}
@@ -0,0 +1,145 @@
+#include "diagnosticparser.hpp"
+
+#include <QDir>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QRegularExpression>
+
+DiagnosticParser::DiagnosticParser(QObject *parent)
+    : QObject(parent)
+{
+
+}
+
+void DiagnosticParser::start(quint64 build_id, const QString &working_directory) {
+    this->build_id = build_id;
+    this->working_directory = working_directory;
+    pending.clear();
+    count = 0;
+}
+
+void DiagnosticParser::feed(quint64 build_id, const QByteArray &data) {
+    if (build_id != this->build_id) {
+        return;
+    }
+
+    pending += data;
+
+    QVector<Diagnostic> diagnostics;
+
+    qsizetype line_begin = 0;
+    for (qsizetype line_end; (line_end = pending.indexOf('\n', line_begin)) != -1; line_begin = line_end + 1) {
+        parse_line(pending.mid(line_begin, line_end - line_begin), diagnostics);
+    }
+    pending.remove(0, line_begin);
+
+    if (!diagnostics.isEmpty()) {
+        emit parsed(build_id, diagnostics);
+    }
+}
+
+void DiagnosticParser::finish(quint64 build_id) {
+    if (build_id != this->build_id) {
+        return;
+    }
+
+    QVector<Diagnostic> diagnostics;
+    parse_line(pending, diagnostics);
+    pending.clear();
+
+    if (!diagnostics.isEmpty()) {
+        emit parsed(build_id, diagnostics);
+    }
+}
+
+void DiagnosticParser::parse_line(const QByteArray &line, QVector<Diagnostic> &diagnostics) {
+    if (count >= MAX_DIAGNOSTICS) {
+        return;
+    }
+
+    const QByteArray trimmed = line.trimmed();
+    if (trimmed.startsWith('[') && trimmed.endsWith(']')) {
+        parse_json(trimmed, diagnostics);
+        return;
+    }
+
+    // colours are only there with -fdiagnostics-color=always, but cheap to drop
+    static const QRegularExpression escape_re("\x1b\\[[0-9;]*[mK]");
+    static const QRegularExpression diagnostic_re("^(.+?):(\\d+):(?:(\\d+):)? (fatal error|error|warning|note): (.*)$");
+
+    QString text = QString::fromUtf8(line);
+    text.remove(escape_re);
+
+    const QRegularExpressionMatch match = diagnostic_re.match(text);
+    if (!match.hasMatch()) {
+        return;
+    }
+
+    Diagnostic diagnostic;
+    diagnostic.file = match.captured(1);
+    diagnostic.line = match.captured(2).toInt();
+    diagnostic.column = match.captured(3).toInt();
+    diagnostic.message = match.captured(5);
+
+    const QString severity = match.captured(4);
+    if (severity == "warning") {
+        diagnostic.severity = DiagnosticSeverity::WARNING;
+    } else if (severity == "note") {
+        diagnostic.severity = DiagnosticSeverity::NOTE;
+    }
+
+    add(diagnostic, diagnostics);
+}
+
+void DiagnosticParser::parse_json(const QByteArray &line, QVector<Diagnostic> &diagnostics) {
+    const QJsonDocument document = QJsonDocument::fromJson(line);
+    if (!document.isArray()) {
+        return;
+    }
+
+    for (const auto &value : document.array()) {
+        add_json_diagnostic(value.toObject(), diagnostics);
+    }
+}
+
+void DiagnosticParser::add_json_diagnostic(const QJsonObject &object, QVector<Diagnostic> &diagnostics) {
+    Diagnostic diagnostic;
+    diagnostic.message = object["message"].toString();
+
+    // "error", "fatal error", "sorry", "ice" and so on are all errors
+    const QString kind = object["kind"].toString();
+    if (kind == "warning") {
+        diagnostic.severity = DiagnosticSeverity::WARNING;
+    } else if (kind == "note") {
+        diagnostic.severity = DiagnosticSeverity::NOTE;
+    }
+
+    const QJsonArray locations = object["locations"].toArray();
+    if (!locations.isEmpty()) {
+        const QJsonObject caret = locations.first().toObject()["caret"].toObject();
+        diagnostic.file = caret["file"].toString();
+        diagnostic.line = caret["line"].toInt();
+        diagnostic.column = caret["display-column"].toInt(caret["column"].toInt());
+    }
+
+    // messages without a location, e.g. linker ones, are left to the terminal
+    if (!diagnostic.file.isEmpty()) {
+        add(diagnostic, diagnostics);
+    }
+
+    for (const auto &child : object["children"].toArray()) {
+        add_json_diagnostic(child.toObject(), diagnostics);
+    }
+}
+
+void DiagnosticParser::add(Diagnostic diagnostic, QVector<Diagnostic> &diagnostics) {
+    if (count >= MAX_DIAGNOSTICS) {
+        return;
+    }
+
+    diagnostic.file = QDir::cleanPath(QDir(working_directory).absoluteFilePath(diagnostic.file));
+
+    diagnostics.push_back(diagnostic);
+    ++count;
+}
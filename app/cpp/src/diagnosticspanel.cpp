@@ -0,0 +1,76 @@
+#include "diagnosticspanel.hpp"
+
+#include <QBrush>
+#include <QFileInfo>
+#include <QHeaderView>
+
+DiagnosticsPanel::DiagnosticsPanel(QWidget *parent)
+    : QTreeWidget(parent)
+{
+    setUniformRowHeights(true);
+    setHeaderLabels({"Location", "Message"});
+    header()->setStretchLastSection(true);
+
+    connect(this, &QTreeWidget::itemClicked, this, [this] (QTreeWidgetItem *item) {
+        emit location_activated(item->data(LOCATION, Qt::UserRole).toString(),
+                                item->data(LOCATION, Qt::UserRole + 1).toInt(),
+                                item->data(LOCATION, Qt::UserRole + 2).toInt());
+    });
+}
+
+void DiagnosticsPanel::reset() {
+    clear();
+    last_top_level = nullptr;
+    errors = 0;
+    warnings = 0;
+}
+
+void DiagnosticsPanel::add(const QVector<Diagnostic> &diagnostics) {
+    // thousands of rows at once are laid out in one go
+    setUpdatesEnabled(false);
+
+    for (const auto &diagnostic : diagnostics) {
+        QTreeWidgetItem *item;
+        if (diagnostic.severity == DiagnosticSeverity::NOTE && last_top_level != nullptr) {
+            item = new QTreeWidgetItem(last_top_level);
+        } else {
+            item = new QTreeWidgetItem(this);
+            last_top_level = item;
+        }
+
+        QString location = QFileInfo(diagnostic.file).fileName() + ':' + QString::number(diagnostic.line);
+        if (diagnostic.column > 0) {
+            location += ':' + QString::number(diagnostic.column);
+        }
+
+        item->setText(LOCATION, location);
+        item->setToolTip(LOCATION, diagnostic.file);
+        item->setData(LOCATION, Qt::UserRole, diagnostic.file);
+        item->setData(LOCATION, Qt::UserRole + 1, diagnostic.line);
+        item->setData(LOCATION, Qt::UserRole + 2, diagnostic.column);
+
+        item->setText(MESSAGE, diagnostic.message);
+        item->setToolTip(MESSAGE, diagnostic.message);
+
+        switch (diagnostic.severity) {
+            case DiagnosticSeverity::ERROR:
+                item->setForeground(MESSAGE, QBrush(Qt::red));
+                ++errors;
+                break;
+            case DiagnosticSeverity::WARNING:
+                item->setForeground(MESSAGE, QBrush(Qt::darkYellow));
+                ++warnings;
+                break;
+            case DiagnosticSeverity::NOTE:
+                item->setForeground(MESSAGE, QBrush(Qt::darkGray));
+                break;
+        }
+    }
+
+    setUpdatesEnabled(true);
+}
+
+QString DiagnosticsPanel::summary() const {
+    return QString::number(errors) + (errors == 1 ? " error, " : " errors, ")
+         + QString::number(warnings) + (warnings == 1 ? " warning" : " warnings");
+}
@@ -0,0 +1,46 @@
+#include "diffviewer.hpp"
+#include "ui_diffviewer.h"
+
+#include <QPlainTextEdit>
+#include <QTextBlock>
+
+#include "linediff.hpp"
+
+DiffViewer::DiffViewer(const QString &expected_file, const QString &output_file, QWidget *parent)
+    : QDialog(parent), ui(new Ui::DiffViewer)
+{
+    ui->setupUi(this);
+
+    const LineDifference difference = LineDiff::first_difference(expected_file, output_file, CONTEXT_LINES);
+
+    if (difference.identical) {
+        ui->summary_label->setText("The outputs are identical up to whitespace");
+        return;
+    }
+
+    ui->summary_label->setText("First difference at line " + QString::number(difference.line));
+
+    show_context(ui->expected_view, difference.expected_context, difference.first_context_line, difference.line);
+    show_context(ui->output_view, difference.output_context, difference.first_context_line, difference.line);
+}
+
+DiffViewer::~DiffViewer() {
+    delete ui;
+}
+
+void DiffViewer::show_context(QPlainTextEdit *view, const QStringList &lines, qint64 first_line, qint64 highlighted_line) {
+    QStringList numbered;
+    for (int i = 0; i < lines.size(); ++i) {
+        numbered << QString::number(first_line + i).rightJustified(6) + "  " + lines[i];
+    }
+    view->setPlainText(numbered.join('\n'));
+
+    QTextEdit::ExtraSelection selection;
+    selection.format.setBackground(QColor(255, 0, 0, 60));
+    selection.format.setProperty(QTextFormat::FullWidthSelection, true);
+    selection.cursor = QTextCursor(view->document()->findBlockByNumber(int(highlighted_line - first_line)));
+    view->setExtraSelections({selection});
+
+    view->setTextCursor(selection.cursor);
+    view->centerCursor();
+}
@@ -0,0 +1,55 @@
+#include "fileloader.hpp"
+
+#include <QFile>
+#include <QStringDecoder>
+#include <QThread>
+
+FileLoader::FileLoader(const QString &file_name, QObject *parent)
+    : QObject(parent), file_name(file_name)
+{
+
+}
+
+void FileLoader::load() {
+    QFile file(file_name);
+
+    if (!file.open(QIODevice::ReadOnly)) {
+        emit failed(file.errorString());
+        return;
+    }
+
+    const qint64 file_size = file.size();
+    qint64 read_size = 0;
+
+    // the decoder keeps multi-byte sequences split between chunks
+    QStringDecoder decoder(QStringDecoder::Utf8);
+
+    while (!file.atEnd()) {
+        if (QThread::currentThread()->isInterruptionRequested()) {
+            emit finished();
+            return;
+        }
+
+        const QByteArray bytes = file.read(CHUNK_SIZE);
+        if (bytes.isEmpty()) {
+            emit failed(file.errorString());
+            return;
+        }
+
+        read_size += bytes.size();
+
+        const QString text = decoder(bytes);
+        const int percent = file_size ? int(read_size * 100 / file_size) : 100;
+        emit chunk_loaded(text, percent);
+    }
+
+    // a sequence cut off by the end of the file is still held by the decoder;
+    // a newline flushes it as U+FFFD and is dropped again
+    QString tail = decoder(QByteArrayView("\n"));
+    tail.chop(1);
+    if (!tail.isEmpty()) {
+        emit chunk_loaded(tail, 100);
+    }
+
+    emit finished();
+}
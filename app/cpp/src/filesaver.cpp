@@ -0,0 +1,77 @@
+#include "filesaver.hpp"
+
+#include <QFileInfo>
+#include <QSaveFile>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "piecetable.hpp"
+
+// makes the rename itself durable
+static void sync_directory(const QString &dir_path) {
+    const int fd = ::open(QFile::encodeName(dir_path).constData(), O_RDONLY | O_DIRECTORY);
+    if (fd < 0) {
+        return;
+    }
+
+    ::fsync(fd);
+    ::close(fd);
+}
+
+FileSaver::FileSaver(QObject *parent)
+    : QObject(parent)
+{
+
+}
+
+void FileSaver::save(quint64 id, const QString &file_name, const QString &contents) {
+    QSaveFile file(file_name);
+
+    if (!file.open(QIODevice::WriteOnly)) {
+        emit failed(id, file.errorString());
+        return;
+    }
+
+    const QByteArray bytes = contents.toUtf8();
+
+    if (file.write(bytes) != bytes.size()) {
+        const QString error = file.errorString();
+        file.cancelWriting();
+        emit failed(id, error);
+        return;
+    }
+
+    commit(id, file_name, file);
+}
+
+void FileSaver::save_pieces(quint64 id, const QString &file_name, const PieceTable &pieces) {
+    // the original is still mapped, so it is never truncated in place
+    QSaveFile file(file_name);
+
+    if (!file.open(QIODevice::WriteOnly)) {
+        emit failed(id, file.errorString());
+        return;
+    }
+
+    if (!pieces.write_to(&file)) {
+        const QString error = file.errorString();
+        file.cancelWriting();
+        emit failed(id, error);
+        return;
+    }
+
+    commit(id, file_name, file);
+}
+
+void FileSaver::commit(quint64 id, const QString &file_name, QSaveFile &file) {
+    // commit() fsyncs the temporary file before renaming it over the target
+    if (!file.commit()) {
+        emit failed(id, file.errorString());
+        return;
+    }
+
+    sync_directory(QFileInfo(file_name).absolutePath());
+
+    emit saved(id);
+}
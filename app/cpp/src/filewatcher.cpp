@@ -0,0 +1,90 @@
+#include "filewatcher.hpp"
+
+#include <QFileInfo>
+#include <QFileSystemWatcher>
+#include <QTimer>
+
+FileWatcher::FileWatcher(QObject *parent)
+    : QObject(parent)
+{
+    watcher = new QFileSystemWatcher(this);
+
+    debounce_timer = new QTimer(this);
+    debounce_timer->setSingleShot(true);
+    debounce_timer->setInterval(DEBOUNCE_MS);
+
+    connect(watcher, &QFileSystemWatcher::fileChanged, this, &FileWatcher::path_changed);
+    connect(watcher, &QFileSystemWatcher::directoryChanged, this, &FileWatcher::directory_changed);
+    connect(debounce_timer, &QTimer::timeout, this, &FileWatcher::flush);
+}
+
+void FileWatcher::watch(const QString &file_name) {
+    if (files.contains(file_name)) {
+        return;
+    }
+
+    files.insert(file_name);
+    watcher->addPath(file_name);
+
+    const QString directory = QFileInfo(file_name).absolutePath();
+    if (directories[directory]++ == 0) {
+        watcher->addPath(directory);
+    }
+}
+
+void FileWatcher::unwatch(const QString &file_name) {
+    if (!files.remove(file_name)) {
+        return;
+    }
+
+    watcher->removePath(file_name);
+    pending.remove(file_name);
+
+    const QString directory = QFileInfo(file_name).absolutePath();
+    if (--directories[directory] == 0) {
+        directories.remove(directory);
+        watcher->removePath(directory);
+    }
+}
+
+void FileWatcher::path_changed(const QString &path) {
+    if (!files.contains(path)) {
+        return;
+    }
+
+    pending.insert(path);
+
+    // restarted on every event, so a burst is reported once it settles
+    debounce_timer->start();
+}
+
+void FileWatcher::directory_changed(const QString &path) {
+    // inotify drops a file's watch when it's replaced, look for it again
+    const QStringList watched_files = watcher->files();
+
+    for (const auto &file_name : std::as_const(files)) {
+        if (QFileInfo(file_name).absolutePath() == path && !watched_files.contains(file_name)
+            && QFileInfo::exists(file_name)) {
+            path_changed(file_name);
+        }
+    }
+}
+
+void FileWatcher::flush() {
+    const QSet<QString> changed = pending;
+    pending.clear();
+
+    const QStringList watched_files = watcher->files();
+
+    for (const auto &file_name : changed) {
+        if (!QFileInfo::exists(file_name)) {
+            continue; // deleted, picked up again by directory_changed if recreated
+        }
+
+        if (!watched_files.contains(file_name)) {
+            watcher->addPath(file_name);
+        }
+
+        emit file_changed(file_name);
+    }
+}
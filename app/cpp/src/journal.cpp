@@ -0,0 +1,130 @@
+#include "journal.hpp"
+
+#include <QDataStream>
+#include <QDir>
+#include <QFile>
+#include <QIODevice>
+#include <QStandardPaths>
+
+QString Journal::directory() {
+    return QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + "/journal";
+}
+
+QString Journal::file_path(quint64 id) {
+    return directory() + '/' + QString::number(id, 16) + ".log";
+}
+
+QVector<quint64> Journal::list() {
+    QVector<quint64> ids;
+
+    const QStringList logs = QDir(directory()).entryList({"*.log"}, QDir::Files);
+    for (const auto &log : logs) {
+        bool ok;
+        const quint64 id = log.chopped(4).toULongLong(&ok, 16);
+        if (ok) {
+            ids.push_back(id);
+        }
+    }
+
+    return ids;
+}
+
+void Journal::clear() {
+    for (const quint64 id : list()) {
+        QFile::remove(file_path(id));
+    }
+}
+
+QByteArray Journal::encode_header(const std::optional<QString> &file_name) {
+    QByteArray bytes;
+    QDataStream stream(&bytes, QIODevice::WriteOnly);
+    stream.setVersion(QDataStream::Qt_6_0);
+
+    stream << MAGIC << VERSION << file_name.has_value() << file_name.value_or(QString());
+
+    return bytes;
+}
+
+QByteArray Journal::encode_snapshot(const QString &text) {
+    QByteArray bytes;
+    QDataStream stream(&bytes, QIODevice::WriteOnly);
+    stream.setVersion(QDataStream::Qt_6_0);
+
+    stream << quint8(SNAPSHOT) << text;
+
+    return bytes;
+}
+
+QByteArray Journal::encode_delta(int position, int removed, const QString &text) {
+    QByteArray bytes;
+    QDataStream stream(&bytes, QIODevice::WriteOnly);
+    stream.setVersion(QDataStream::Qt_6_0);
+
+    stream << quint8(DELTA) << qint32(position) << qint32(removed) << text;
+
+    return bytes;
+}
+
+std::optional<RecoveredBuffer> Journal::replay(quint64 id) {
+    QFile file(file_path(id));
+    if (!file.open(QIODevice::ReadOnly)) {
+        return std::nullopt;
+    }
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_6_0);
+
+    quint32 magic;
+    quint16 version;
+    bool has_file_name;
+    QString file_name;
+    stream >> magic >> version >> has_file_name >> file_name;
+
+    if (stream.status() != QDataStream::Ok || magic != MAGIC || version > VERSION) {
+        return std::nullopt;
+    }
+
+    RecoveredBuffer buffer;
+    if (has_file_name) {
+        buffer.file_name = file_name;
+    }
+
+    bool has_snapshot = false;
+
+    while (!stream.atEnd()) {
+        quint8 type;
+        stream >> type;
+
+        if (type == SNAPSHOT) {
+            QString text;
+            stream >> text;
+
+            if (stream.status() != QDataStream::Ok) {
+                break;
+            }
+
+            buffer.text = text;
+            has_snapshot = true;
+        } else if (type == DELTA) {
+            qint32 position, removed;
+            QString text;
+            stream >> position >> removed >> text;
+
+            if (stream.status() != QDataStream::Ok) {
+                break;
+            }
+
+            position = qBound<qint32>(0, position, buffer.text.size());
+            removed = qBound<qint32>(0, removed, buffer.text.size() - position);
+            buffer.text.replace(position, removed, text);
+        } else {
+            break;
+        }
+    }
+
+    if (!has_snapshot) {
+        return std::nullopt;
+    }
+
+    return buffer;
+}
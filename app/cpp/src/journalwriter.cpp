@@ -0,0 +1,59 @@
+#include "journalwriter.hpp"
+
+#include <QDir>
+#include <QFile>
+#include <QSaveFile>
+#include <QDebug>
+
+#include <unistd.h>
+
+#include "journal.hpp"
+
+JournalWriter::JournalWriter(QObject *parent)
+    : QObject(parent)
+{
+
+}
+
+JournalWriter::~JournalWriter() {
+    qDeleteAll(files);
+}
+
+void JournalWriter::replace(quint64 id, const QByteArray &bytes) {
+    close(id);
+
+    QDir().mkpath(Journal::directory());
+
+    QSaveFile file(Journal::file_path(id));
+    if (!file.open(QIODevice::WriteOnly) || file.write(bytes) != bytes.size() || !file.commit()) {
+        qWarning() << "Can't write journal" << file.fileName() << file.errorString();
+    }
+}
+
+void JournalWriter::append(quint64 id, const QByteArray &bytes) {
+    QFile *file = files.value(id);
+
+    if (file == nullptr) {
+        file = new QFile(Journal::file_path(id));
+        if (!file->open(QIODevice::WriteOnly | QIODevice::Append)) {
+            qWarning() << "Can't open journal" << file->fileName() << file->errorString();
+            delete file;
+            return;
+        }
+
+        files.insert(id, file);
+    }
+
+    file->write(bytes);
+    file->flush();
+    ::fdatasync(file->handle());
+}
+
+void JournalWriter::discard(quint64 id) {
+    close(id);
+    QFile::remove(Journal::file_path(id));
+}
+
+void JournalWriter::close(quint64 id) {
+    delete files.take(id);
+}
@@ -0,0 +1,129 @@
+#include "linediff.hpp"
+
+#include <QByteArray>
+#include <QCryptographicHash>
+#include <QFile>
+
+#include <cctype>
+#include <deque>
+
+namespace {
+
+class LineReader
+{
+public:
+    LineReader(const QString &file_name)
+        : file(file_name)
+    {
+        file.open(QIODevice::ReadOnly);
+    }
+
+    bool at_end() const {
+        return !file.isOpen() || file.atEnd();
+    }
+
+    // hash of the next line without trailing whitespace, and its start for previewing
+    QByteArray next(QByteArray &preview, int preview_size) {
+        QCryptographicHash hash(QCryptographicHash::Md5);
+        preview.clear();
+
+        // a line can be far longer than a read, it's hashed piece by piece
+        QByteArray pending_space;
+        bool line_end = false;
+        while (!line_end && !file.atEnd()) {
+            QByteArray chunk = file.readLine(CHUNK_SIZE);
+            if (chunk.endsWith('\n')) {
+                line_end = true;
+            }
+
+            qsizetype content_end = chunk.size();
+            while (content_end > 0 && std::isspace(static_cast<unsigned char>(chunk[content_end - 1]))) {
+                --content_end;
+            }
+
+            if (content_end > 0) {
+                hash.addData(pending_space);
+                pending_space.clear();
+                hash.addData(chunk.first(content_end));
+            }
+            pending_space += chunk.mid(content_end);
+
+            if (preview.size() < preview_size) {
+                preview += chunk.left(preview_size - preview.size());
+            }
+        }
+
+        while (!preview.isEmpty() && std::isspace(static_cast<unsigned char>(preview.back()))) {
+            preview.chop(1);
+        }
+
+        return hash.result();
+    }
+
+private:
+    static constexpr qint64 CHUNK_SIZE = 1 << 16;
+
+    QFile file;
+};
+
+}
+
+LineDifference LineDiff::first_difference(const QString &expected_file, const QString &output_file,
+                                          int context_lines) {
+    LineReader expected(expected_file);
+    LineReader output(output_file);
+
+    LineDifference difference;
+
+    std::deque<QByteArray> expected_history;
+    std::deque<QByteArray> output_history;
+
+    for (qint64 line = 1; !expected.at_end() || !output.at_end(); ++line) {
+        QByteArray expected_preview, output_preview;
+
+        // a file that has ended reads as empty lines, so trailing blank lines don't count
+        const QByteArray expected_hash = expected.next(expected_preview, MAX_PREVIEW);
+        const QByteArray output_hash = output.next(output_preview, MAX_PREVIEW);
+
+        if (expected_hash == output_hash) {
+            expected_history.push_back(expected_preview);
+            output_history.push_back(output_preview);
+
+            if (int(expected_history.size()) > context_lines) {
+                expected_history.pop_front();
+                output_history.pop_front();
+            }
+            continue;
+        }
+
+        difference.identical = false;
+        difference.line = line;
+        difference.first_context_line = line - qint64(expected_history.size());
+
+        for (const auto &preview : expected_history) {
+            difference.expected_context << QString::fromUtf8(preview);
+        }
+        for (const auto &preview : output_history) {
+            difference.output_context << QString::fromUtf8(preview);
+        }
+
+        // the differing line and a few after it
+        for (int i = 0; i <= context_lines; ++i) {
+            if (i > 0) {
+                if (expected.at_end() && output.at_end()) {
+                    break;
+                }
+
+                expected.next(expected_preview, MAX_PREVIEW);
+                output.next(output_preview, MAX_PREVIEW);
+            }
+
+            difference.expected_context << QString::fromUtf8(expected_preview);
+            difference.output_context << QString::fromUtf8(output_preview);
+        }
+
+        break;
+    }
+
+    return difference;
+}
@@ -1,8 +1,6 @@
 #include "mainwindow.hpp"
 #include "ui_mainwindow.h"
 
-#include <algorithm>
-
 #include <QMessageBox>
 #include <QFileDialog>
 #include <QDebug>
@@ -18,12 +16,45 @@
 #include <QNetworkReply>
 #include <QJsonDocument>
 #include <QJsonObject>
+#include <QThread>
+#include <QTextCursor>
+#include <QTimer>
+#include <QEvent>
+#include <QScrollBar>
+#include <QSet>
+#include <QProcess>
+#include <QStatusBar>
+#include <QDockWidget>
+#include <QJsonArray>
+#include <QActionGroup>
+#include <QTextBlock>
+
+#include <algorithm>
 
-#include "qsourcehighliter.h"
 #include "fs.hpp"
 
+#include "bufferjournal.hpp"
+#include "buildcache.hpp"
+#include "buildrunner.hpp"
 #include "codeeditor.hpp"
+#include "fileloader.hpp"
+#include "filesaver.hpp"
+#include "filewatcher.hpp"
+#include "journal.hpp"
+#include "journalwriter.hpp"
+#include "pchbuilder.hpp"
+#include "piecetable.hpp"
+#include "testpanel.hpp"
+#include "testrunner.hpp"
 #include "preferencesdialog.hpp"
+#include "sessionstore.hpp"
+#include "stressdialog.hpp"
+#include "teststore.hpp"
+#include "diffviewer.hpp"
+#include "stresstester.hpp"
+#include "diagnosticparser.hpp"
+#include "diagnosticspanel.hpp"
+#include "profiler.hpp"
 #include "probleminputdialog.hpp"
 
 #include "ds/problem.hpp"
@@ -33,6 +64,8 @@
 MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent), ui(new Ui::MainWindow)
 {
+    startup_timer.start();
+
     ui->setupUi(this);
 
     fs_model = new QFileSystemModel;
@@ -43,63 +76,156 @@ MainWindow::MainWindow(QWidget *parent)
     connect(ui->tree_view, &QTreeView::doubleClicked, this, &MainWindow::open_folder_file);
 
     connect(ui->tab_widget, &QTabWidget::tabCloseRequested, this, &MainWindow::close_tab);
+    connect(ui->tab_widget, &QTabWidget::currentChanged, this, &MainWindow::tab_activated);
+
+    save_thread = new QThread(this);
+    file_saver = new FileSaver;
+    file_saver->moveToThread(save_thread);
+
+    connect(save_thread, &QThread::finished, file_saver, &QObject::deleteLater);
+    connect(file_saver, &FileSaver::saved, this, &MainWindow::file_saved);
+    connect(file_saver, &FileSaver::failed, this, &MainWindow::file_save_failed);
+
+    build_runner = new BuildRunner(this);
+    connect(build_runner, &BuildRunner::output, ui->terminal, &QLightTerminal::printOutput);
+    connect(build_runner, &BuildRunner::output, this, [this] (const QByteArray &data) {
+        QMetaObject::invokeMethod(diagnostic_parser, [parser = diagnostic_parser, id = build_id, data] () {
+            parser->feed(id, data);
+        });
+    });
+    connect(build_runner, &BuildRunner::finished, this, &MainWindow::build_finished);
+
+    pch_builder = new PchBuilder(this);
+
+    // long template errors are parsed off the UI thread
+    diagnostics_thread = new QThread(this);
+    diagnostic_parser = new DiagnosticParser;
+    diagnostic_parser->moveToThread(diagnostics_thread);
+
+    connect(diagnostics_thread, &QThread::finished, diagnostic_parser, &QObject::deleteLater);
+    connect(diagnostic_parser, &DiagnosticParser::parsed, this, &MainWindow::diagnostics_parsed);
+
+    diagnostics_thread->start();
+
+    diagnostics_panel = new DiagnosticsPanel;
+    connect(diagnostics_panel, &DiagnosticsPanel::location_activated, this, &MainWindow::show_diagnostic);
+    diagnostics_dock = new QDockWidget("Problems", this);
+    diagnostics_dock->setObjectName("diagnostics_dock");
+    diagnostics_dock->setWidget(diagnostics_panel);
+    addDockWidget(Qt::BottomDockWidgetArea, diagnostics_dock);
+    diagnostics_dock->hide();
+
+    test_runner = new TestRunner(this);
+    connect(test_runner, &TestRunner::test_finished, this, &MainWindow::test_finished);
+    connect(test_runner, &TestRunner::finished, this, &MainWindow::tests_finished);
+
+    stress_tester = new StressTester(this);
+    connect(stress_tester, &StressTester::progress, this, &MainWindow::stress_progress);
+    connect(stress_tester, &StressTester::failed, this, &MainWindow::stress_failed);
+    connect(stress_tester, &StressTester::finished, this, &MainWindow::stress_finished);
+
+    profiler = new Profiler(this);
+    connect(profiler, &Profiler::finished, this, &MainWindow::profile_finished);
+
+    test_panel = new TestPanel;
+    connect(test_panel, &TestPanel::diff_requested, this, &MainWindow::show_test_diff);
+    test_dock = new QDockWidget("Tests", this);
+    test_dock->setObjectName("test_dock");
+    test_dock->setWidget(test_panel);
+    addDockWidget(Qt::RightDockWidgetArea, test_dock);
+    test_dock->hide();
+
+    file_watcher = new FileWatcher(this);
+    connect(file_watcher, &FileWatcher::file_changed, this, &MainWindow::file_changed_on_disk);
+
+    journal_writer = new JournalWriter;
+    journal_writer->moveToThread(save_thread);
+    connect(save_thread, &QThread::finished, journal_writer, &QObject::deleteLater);
+
+    save_thread->start();
+
+    session_timer = new QTimer(this);
+    session_timer->setSingleShot(true);
+    session_timer->setInterval(SESSION_WRITE_INTERVAL_MS);
+    connect(session_timer, &QTimer::timeout, this, &MainWindow::write_session);
+
+    // the build profile of the current file, filled from the preferences
+    profile_menu = ui->run_menu->addMenu("Build Profile");
+    profile_group = new QActionGroup(this);
+    profile_group->setExclusive(true);
+    connect(profile_group, &QActionGroup::triggered, this, &MainWindow::profile_selected);
 
     read_settings();
+    rebuild_profile_menu();
+
+    QTimer::singleShot(SESSION_RESTORE_FALLBACK_MS, this, &MainWindow::restore_session);
 }
 
 MainWindow::~MainWindow() {
     write_settings();
 
+    // let queued saves reach the disk before exiting
+    save_thread->quit();
+    save_thread->wait();
+
+    diagnostics_thread->quit();
+    diagnostics_thread->wait();
+
+    // unsaved buffers are in the session file now, so the journal is no longer needed
+    if (session_restored) {
+        session_timer->stop();
+        if (SessionStore::write(SessionStore::default_path(), collect_session())) {
+            Journal::clear();
+        }
+    }
+
     delete ui;
 }
 
 void MainWindow::open_new_tab() {
+    add_editor_tab(true);
+}
+
+CodeEditor *MainWindow::add_editor_tab(bool activate) {
     CodeEditor *editor = new CodeEditor(this);
     editor->setFont(preferences.editor_font);
 
-    connect(editor, &CodeEditor::textChanged, this, [&] () {
-        this->set_current_tab_saved(false);
+    connect(editor, &CodeEditor::textChanged, this, [this, editor] () {
+        if (editor->is_loading() || editor->is_unloaded()) {
+            return;
+        }
+
+        schedule_session_write();
     });
 
-    auto *highlighter = new QSourceHighlite::QSourceHighliter(editor->document());
-    highlighter->setCurrentLanguage(QSourceHighlite::QSourceHighliter::CodeCpp); //TODO: determine language by extension
+    editor->set_journal(new BufferJournal(editor, journal_writer));
 
-    QRegularExpression untitled_regexp("Untitled (^\\d+$)");
-    QVector<int> untitled_numbers;
-    const int tabs_amount = ui->tab_widget->count();
-    for (int i = 0; i < tabs_amount; ++i) {
-        const QString tab_name = ui->tab_widget->tabText(i);
-        const auto untitled_regexp_match = untitled_regexp.match(tab_name);
-        if (!untitled_regexp_match.isValid()) {
-            continue;
+    // the title only changes when the document flips between clean and modified
+    connect(editor->document(), &QTextDocument::modificationChanged, this, [this, editor] (bool modified) {
+        if (editor->is_loading()) {
+            return;
         }
 
-        const qsizetype tab_name_begin = tab_name.indexOf('(') + 1;
-        const qsizetype tab_name_end = tab_name.indexOf(')') - 1;
-        const QString tab_number = tab_name.mid(tab_name_begin, tab_name_end - tab_name_begin + 1);
-        untitled_numbers.push_back(tab_number.toInt());
-    }
+        tab_infos[editor].dirty = modified;
+        update_tab_title(editor);
+    });
 
-    std::sort(untitled_numbers.begin(), untitled_numbers.end());
-    int new_tab_number = -1;
-    for (qsizetype i = 1; i < untitled_numbers.size(); ++i) {
-        if (untitled_numbers[i] != untitled_numbers[i-1] + 1) {
-            new_tab_number = untitled_numbers[i-1] + 1;
-            break;
-        }
-    }
+    connect(editor, &CodeEditor::cursorPositionChanged, this, &MainWindow::schedule_session_write);
+    connect(editor->verticalScrollBar(), &QScrollBar::valueChanged, this, &MainWindow::schedule_session_write);
 
-    if (new_tab_number == -1 && untitled_numbers.size()) {
-        new_tab_number = untitled_numbers.back() + 1;
-    }
+    editor->setup_highlighter();
+
+    TabInfo info;
+    info.untitled_id = take_untitled_id();
+    tab_infos.insert(editor, info);
 
-    QString new_tab_name = "Untitled";
-    if (new_tab_number != -1) {
-        new_tab_name += " (" + QString::number(new_tab_number) + ')';
+    ui->tab_widget->addTab(editor, QString());
+    update_tab_title(editor);
+    if (activate) {
+        ui->tab_widget->setCurrentIndex(ui->tab_widget->count() - 1); // go to new tab
     }
 
-    ui->tab_widget->addTab(editor, new_tab_name);
-    ui->tab_widget->setCurrentIndex(ui->tab_widget->count() - 1); // go to new tab
+    return editor;
 }
 
 void MainWindow::close_tab(int index) {
@@ -108,21 +234,31 @@ void MainWindow::close_tab(int index) {
         return;
     }
 
-    auto cur_editor = get_cur_editor();
+    auto tab_editor = get_tab_editor(index);
 
-    bool file_opened = cur_editor->get_file_name().has_value();
-    if (file_opened) {
-        bool is_edited = cur_editor->document()->isModified();
+    bool file_opened = tab_editor->get_file_name().has_value();
+    if (file_opened && !tab_editor->is_loading()) {
+        bool is_edited = tab_editor->document()->isModified();
 
         if (is_edited) {
              const auto ret = QMessageBox::question(this, "File opening", "Do you want to save changes?", QMessageBox::No, QMessageBox::Yes);
             if (ret == QMessageBox::Yes) {
-                save_file(cur_editor->get_file_name().value());
+                tab_editor->restore_from_buffer(); // unloaded tabs keep their edits compressed
+                save_file(tab_editor, tab_editor->get_file_name().value());
             }
         }
     }
     
+    tab_registry.remove(tab_editor);
+    if (tab_editor->get_file_name().has_value()) {
+        file_watcher->unwatch(TabRegistry::canonical_path(tab_editor->get_file_name().value()));
+    }
+    untitled_ids.remove(tab_infos.take(tab_editor).untitled_id);
+
     ui->tab_widget->removeTab(index);
+    tab_editor->deleteLater();
+
+    schedule_session_write();
 }
 
 void MainWindow::close_current_tab() {
@@ -176,7 +312,7 @@ void MainWindow::ask_save_file() {
         }
     }
 
-    save_file(file_name);
+    save_file(cur_editor, file_name);
 
     
 }
@@ -201,7 +337,16 @@ void MainWindow::ask_rename_file() {
     const QString new_name = QInputDialog::getText(this, "Pick a new file name", "New name", QLineEdit::Normal, file_name, &ok);
 
     if (ok && !new_name.isEmpty()) {
-        rename_file(file_path, QFileInfo(file_path).absoluteDir().absolutePath() + '/' + new_name);
+        const QString new_file_path = QFileInfo(file_path).absoluteDir().absolutePath() + '/' + new_name;
+
+        CodeEditor *editor = tab_registry.find(file_path);
+
+        rename_file(file_path, new_file_path);
+
+        // keep an open tab pointing at the renamed file
+        if (editor != nullptr && !QFileInfo::exists(file_path) && QFileInfo::exists(new_file_path)) {
+            set_editor_file(editor, new_file_path);
+        }
     }
 }
 
@@ -259,311 +404,1184 @@ void MainWindow::open_folder_file() {
 }
 
 void MainWindow::compile() {
-    qDebug() << "compile";
-    const auto cur_editor = get_cur_editor();
+    start_compile(AfterBuild::NOTHING);
+}
 
-    std::optional<QString> file_name = cur_editor->get_file_name();
-    if (!file_name.has_value()) {
-        qDebug() << "No file name!";
-        return; 
-    }
+void MainWindow::compile_and_execute() {
+    start_compile(AfterBuild::EXECUTE);
+}
 
-    const QString compile_cmd = preferences.compiler_path + ' ' \
-        + preferences.compiler_args + ' '\
-        + file_name.value() + " -o " + QFileInfo(file_name.value()).baseName() + '\n';
+void MainWindow::stress_test() {
+    QSettings settings(QApplication::organizationName(), QApplication::applicationName());
+    settings.beginGroup("stress");
 
-    ui->terminal->runCommand(compile_cmd);
-}
+    const CodeEditor *cur_editor = get_cur_editor();
+    const QString solution = cur_editor != nullptr && cur_editor->get_file_name().has_value()
+                             ? cur_editor->get_file_name().value()
+                             : settings.value("solution").toString();
 
-void MainWindow::execute() {
-    const auto cur_editor = get_cur_editor();
-    std::optional<QString> file_name = cur_editor->get_file_name();
-    if (!file_name.has_value()) {
+    StressDialog dialog(this);
+    dialog.set_sources(solution, settings.value("brute").toString(), settings.value("generator").toString());
+    dialog.set_cases(settings.value("cases", 1000).toInt());
+
+    if (dialog.exec() != QDialog::Accepted) {
         return;
     }
 
-    const QString exec_cmd = "./" + QFileInfo(file_name.value()).baseName() + '\n';
+    settings.setValue("solution", dialog.solution());
+    settings.setValue("brute", dialog.brute());
+    settings.setValue("generator", dialog.generator());
+    settings.setValue("cases", dialog.cases());
+    settings.endGroup();
 
-    ui->terminal->runCommand(exec_cmd);
-}
+    stress_solution = dialog.solution();
+    stress_brute = dialog.brute();
+    stress_generator = dialog.generator();
+    stress_cases = dialog.cases();
 
-void MainWindow::terminal_focus() {
-    const bool has_focus = ui->terminal->hasFocus();
-    const auto ind_in_splitter = ui->terminal_splitter->indexOf(ui->terminal);
-    auto sizes = ui->terminal_splitter->sizes();
+    stress_store_key = test_store_key();
 
-    if (has_focus) {
-        prev_terminal_height = ui->terminal->height();
+    start_build({build_job(stress_solution), build_job(stress_brute), build_job(stress_generator)}, AfterBuild::STRESS);
+}
 
-        sizes[ind_in_splitter] = 0;
+void MainWindow::start_stress() {
+    const RunLimits limits = run_limits(file_profile(stress_solution));
 
-        ui->terminal->clearFocus();
+    ui->terminal->printOutput(("[stress] running " + QString::number(stress_cases) + " cases\n").toUtf8());
+    statusBar()->showMessage("Stress testing...");
 
-    } else {
-        if (!sizes[ind_in_splitter] && ind_in_splitter && prev_terminal_height <= sizes[ind_in_splitter - 1]) {
-            sizes[ind_in_splitter-1] -= prev_terminal_height; // possible undefined behaviour (ind_in_splitter < 0 or prev_terminal_height > sizes[in...])
-            sizes[ind_in_splitter] = prev_terminal_height;\
-        }
-        ui->terminal->show();
-        ui->terminal->setFocus(Qt::FocusReason::ShortcutFocusReason);
-    }
-    
-    ui->terminal_splitter->setSizes(sizes);
+    stress_tester->start(executable_path(stress_generator, file_profile(stress_generator)),
+                         executable_path(stress_brute, file_profile(stress_brute)),
+                         executable_path(stress_solution, file_profile(stress_solution)),
+                         QFileInfo(stress_solution).absolutePath(), stress_cases, limits);
 }
 
-void MainWindow::editor_focus() {
-    get_cur_editor()->setFocus(Qt::FocusReason::MouseFocusReason);
+void MainWindow::stress_progress(quint64 cases_done) {
+    statusBar()->showMessage("Stress testing: " + QString::number(cases_done) + '/' + QString::number(stress_cases) + " cases passed");
 }
 
-void MainWindow::folder_focus() {
-    ui->tree_view->setFocus(Qt::FocusReason::ShortcutFocusReason);
-}
+void MainWindow::stress_failed(const StressFailure &failure) {
+    const QString verdict = failure.verdict == Verdict::FAILED ? QString() : TestPanel::verdict_name(failure.verdict) + ": ";
+    const QString summary = "case " + QString::number(failure.seed) + ": " + verdict + failure.message;
 
-void MainWindow::load_problem()
-{
-    bool ok;
-    ProblemInputDialog dialog;
-    dialog.exec();
+    ui->terminal->printOutput(("[stress] " + summary + '\n').toUtf8());
+    statusBar()->showMessage("Stress test failed on " + summary, STATUS_MESSAGE_MS);
 
-    if (dialog.result() == QDialog::Rejected) 
-    {
+    if (failure.input.isEmpty()) {
         return;
     }
 
-    QNetworkAccessManager *network_access_manager = new QNetworkAccessManager;
-    connect(network_access_manager, &QNetworkAccessManager::finished, [=] (QNetworkReply *reply)
-    {
-        if (reply->error() != QNetworkReply::NoError)
-        {
-            qWarning() << "Error:" << reply->errorString();
-            reply->deleteLater();
-            return;
-        }
-
-            // Read the data from the reply
-        QByteArray responseData = reply->readAll();
+    // a case that broke the solution is worth keeping
+    if (failure.verdict != Verdict::FAILED && stress_store_key.has_value()) {
+        TestStore(stress_store_key.value()).add("Stress " + QString::number(failure.seed), failure.input, failure.expected);
+    }
 
-        // Parse the data into a QJsonDocument
-        QJsonDocument jsonDoc = QJsonDocument::fromJson(responseData);
+    CodeEditor *editor = add_editor_tab(true);
+    editor->setPlainText(QString::fromUtf8(failure.input));
+}
 
-        // Check if the document is valid and is an object
-        if (!jsonDoc.isNull() && jsonDoc.isObject()) {
-            
-            get_cur_editor()->setPlainText("/*" + jsonDoc.toJson() + "*/" + get_cur_editor()->toPlainText());
+void MainWindow::stress_finished(quint64 cases_done, bool failed) {
+    const QString count = QString::number(cases_done);
+    if (failed) {
+        ui->terminal->printOutput(("[stress] stopped, " + count + " other cases passed before the failure\n").toUtf8());
+        return;
+    }
 
-            // Do something with the jsonObj...
-        } else {
-            qWarning() << "Failed to create JSON object.";
-        }
+    ui->terminal->printOutput(("[stress] " + count + " cases passed\n").toUtf8());
+}
 
-        // Clean up
-        reply->deleteLater();
-    });
+void MainWindow::diagnostics_parsed(quint64 id, const QVector<Diagnostic> &diagnostics) {
+    if (id != build_id) {
+        return;
+    }
 
-    QNetworkRequest request(QString("http://127.0.0.1:3000/problem?source=timus&problem_title=2035"));
-    network_access_manager->get(request);
+    diagnostics_panel->add(diagnostics);
+    diagnostics_dock->show();
 
-    //TODO: check for correct url
-}
+    QSet<QString> files;
+    for (const auto &diagnostic : diagnostics) {
+        const QString path = TabRegistry::canonical_path(diagnostic.file);
+        build_diagnostics[path].push_back(diagnostic);
+        files.insert(path);
+    }
 
-void MainWindow::start_comp()
-{
-    
+    for (const auto &file : files) {
+        CodeEditor *editor = tab_registry.find(file);
+        if (editor != nullptr) {
+            editor->set_diagnostics(build_diagnostics.value(file));
+        }
+    }
 }
 
-void MainWindow::open_preferences() {
-    PreferencesDialog *preferences_dialog = new PreferencesDialog(&preferences);
-    preferences_dialog->setAttribute(Qt::WA_DeleteOnClose);
+void MainWindow::show_diagnostic(const QString &file_name, int line, int column) {
+    if (!QFileInfo::exists(file_name)) {
+        statusBar()->showMessage("Can't find " + file_name, STATUS_MESSAGE_MS);
+        return;
+    }
 
-    preferences_dialog->show();
-}
+    open_file(file_name);
 
-void MainWindow::ask_open_folder() {
-    const QString folder_path = QFileDialog::getExistingDirectory(this, "Open folder", "");
-    if (folder_path.isEmpty()) {
+    CodeEditor *editor = tab_registry.find(file_name);
+    if (editor == nullptr) {
         return;
     }
 
-    open_folder(folder_path);
+    // a file that is still being read is scrolled once it's loaded
+    if (editor->is_loading()) {
+        pending_location = PendingLocation{editor, line, column};
+        return;
+    }
 
-    
+    editor->go_to(line, column);
 }
 
-void MainWindow::show_folder_context_menu(const QPoint &point) const {
-    folder_context_menu->exec(ui->tree_view->viewport()->mapToGlobal(point));
+void MainWindow::run_tests() {
+    if (!load_tests()) {
+        return;
+    }
 
+    start_compile(AfterBuild::TEST);
 }
 
-void MainWindow::set_current_tab_saved(bool status)
-{
-    const int cur_tab_ind = ui->tab_widget->currentIndex();
-    QString cur_tab_text = ui->tab_widget->tabText(cur_tab_ind);
-
-    QStringList cur_tab_text_split = cur_tab_text.split(" ");
+void MainWindow::compare_profiles() {
+    const auto cur_editor = get_cur_editor();
+    if (cur_editor == nullptr || !cur_editor->get_file_name().has_value()) {
+        statusBar()->showMessage("Save the file before compiling", STATUS_MESSAGE_MS);
+        return;
+    }
 
-    if (cur_tab_text_split.last() == "*")
-    {
-        if (status)
-        {
-            cur_tab_text_split.pop_back();
-            ui->tab_widget->setTabText(cur_tab_ind, cur_tab_text_split.join(" "));
-        }
-        else
-        {
-            return;
-        }
+    if (!load_tests()) {
+        return;
     }
-    else
-    {
-        if (!status)
-        {
-            cur_tab_text_split.push_back("*");
-            ui->tab_widget->setTabText(cur_tab_ind, cur_tab_text_split.join(" "));
-        }
-        else
-        {
-            return;
-        }
+
+    test_source = cur_editor->get_file_name().value();
+
+    QVector<BuildJob> jobs;
+    for (const auto &profile : preferences.build_profiles) {
+        jobs.push_back({test_source, profile});
     }
+
+    start_build(jobs, AfterBuild::COMPARE);
 }
 
-void MainWindow::open_file(const QString &file_name) {
-    const int tabs_amount = ui->tab_widget->count();
+void MainWindow::profile_run() {
+    const auto cur_editor = get_cur_editor();
+    if (cur_editor == nullptr || !cur_editor->get_file_name().has_value()) {
+        statusBar()->showMessage("Save the file before compiling", STATUS_MESSAGE_MS);
+        return;
+    }
 
-    for (int i = 0; i < tabs_amount; ++i) {
-        auto tab_editor = get_tab_editor(i);
-        std::optional<QString> editor_file_name = tab_editor->get_file_name();
-        if (editor_file_name.has_value() && editor_file_name.value() == file_name) {
-            ui->tab_widget->setCurrentIndex(i);
-            return;
-        }
+    if (!load_tests()) {
+        return;
     }
 
-    QFile file(file_name);
+    QStringList names;
+    for (const auto &test : tests) {
+        names << test.name;
+    }
 
-    if (!file.open(QIODevice::ReadOnly)) {
-        QMessageBox::critical(this, "Error", "Can't open file", QMessageBox::Ok);
+    bool ok = false;
+    const QString name = QInputDialog::getItem(this, "Profile Run", "Test to profile:", names, 0, false, &ok);
+    if (!ok) {
         return;
     }
 
-    QString file_contents = file.readAll();
+    profiled_test = tests[qMax(0, names.indexOf(name))];
+    test_source = cur_editor->get_file_name().value();
 
-    file.close();
+    // the file's own flags plus the debug info the samples are mapped with
+    BuildProfile profile = file_profile(test_source);
+    profile.name += " profiling";
+    profile.compiler_args += " -g";
 
-    open_new_tab();
+    start_build({{test_source, profile}}, AfterBuild::PROFILE);
+}
 
-    auto cur_editor = get_cur_editor();
+void MainWindow::start_profile() {
+    const RunLimits limits = run_limits(file_profile(test_source));
 
-    cur_editor->setPlainText(file_contents);
-    cur_editor->set_file_name(file.fileName());
-    cur_editor->document()->setModified(false);
+    statusBar()->showMessage("Profiling on " + profiled_test.name + "...");
 
-    const int cur_tab_ind = ui->tab_widget->currentIndex();
-    ui->tab_widget->setTabText(cur_tab_ind, QFileInfo(file.fileName()).fileName());
+    profiler->run(build_output, test_source, profiled_test, limits);
 }
 
-void MainWindow::save_file(const QString &file_name) {
-    QFile file(file_name);
+void MainWindow::profile_finished(const ProfileResult &result) {
+    static constexpr int HOT_LINES_SHOWN = 10;
 
-    if (!file.open(QIODevice::WriteOnly)) {
-        QMessageBox::critical(this, "Error", "Can't open file", QMessageBox::Ok);
+    if (!result.error.isEmpty()) {
+        ui->terminal->printOutput(("[profile] " + result.error + '\n').toUtf8());
+        statusBar()->showMessage("Profiling failed: " + result.error, STATUS_MESSAGE_MS);
         return;
     }
 
-    file.write(get_cur_editor()->toPlainText().toUtf8());
-
-    file.close();
+    auto percent = [&result] (quint64 samples) {
+        return QString::number(100.0 * samples / result.total_samples, 'f', 1) + '%';
+    };
 
-    const int cur_tab_ind = ui->tab_widget->currentIndex();
-    ui->tab_widget->setTabText(cur_tab_ind, QFileInfo(file.fileName()).fileName());
+    QString report = "[profile] " + result.test_name + ": cpu " + QString::number(result.run.cpu_time_ms) + " ms, "
+                   + QString::number(result.total_samples) + " samples, "
+                   + percent(result.source_samples) + " in " + QFileInfo(test_source).fileName() + ", "
+                   + percent(result.outside_samples) + " in libraries";
+    if (result.lost_samples) {
+        report += ", " + QString::number(result.lost_samples) + " lost";
+    }
+    report += '\n';
 
-    get_cur_editor()->set_file_name(file_name);
+    QVector<QPair<quint64, int>> hot_lines;
+    quint64 hottest = 0;
+    for (auto it = result.line_samples.cbegin(); it != result.line_samples.cend(); ++it) {
+        hot_lines.push_back({it.value(), it.key()});
+        hottest = qMax(hottest, it.value());
+    }
+    std::sort(hot_lines.rbegin(), hot_lines.rend());
 
-    get_cur_editor()->document()->setModified(false);
-    set_current_tab_saved(true);
-}
+    CodeEditor *editor = tab_registry.find(test_source);
 
-void MainWindow::open_folder(const QString &folder_name) {
-    if (!is_folder_opened) {
-        ui->tree_view->setModel(fs_model);
-        is_folder_opened = true;
+    for (int i = 0; i < hot_lines.size() && i < HOT_LINES_SHOWN; ++i) {
+        report += "  line " + QString::number(hot_lines[i].second) + ": " + percent(hot_lines[i].first);
 
-        ui->tree_view->setHeaderHidden(true);
-        for (int i = 1; i < fs_model->columnCount(); ++i) {
-            ui->tree_view->setColumnHidden(i, true);
+        if (editor != nullptr && !editor->is_unloaded()) {
+            report += "  " + editor->document()->findBlockByNumber(hot_lines[i].second - 1).text().trimmed();
         }
+        report += '\n';
     }
 
-    ui->tree_view->setRootIndex(fs_model->index(folder_name));
-    ui->terminal->setDirectory(folder_name);
+    ui->terminal->printOutput(report.toUtf8());
+    statusBar()->showMessage("Profiled on " + result.test_name, STATUS_MESSAGE_MS);
 
-    is_folder_opened = true;
-}
+    if (editor != nullptr) {
+        QHash<int, double> heat;
+        for (const auto &[samples, line] : hot_lines) {
+            heat[line] = double(samples) / hottest;
+        }
 
-QString MainWindow::get_opened_folder() const {
-    return fs_model->fileInfo(ui->tree_view->rootIndex()).absoluteFilePath();
+        editor->set_line_heat(heat);
+    }
 }
 
-void MainWindow::write_settings() {
-    QSettings settings(QApplication::organizationName(), QApplication::applicationName());
+bool MainWindow::load_tests() {
+    const std::optional<QString> key = test_store_key();
+    tests = key.has_value() ? TestStore(key.value()).tests() : QVector<TestCase>();
 
-    settings.setValue("tree_view_width", ui->tree_view->width());
-    settings.setValue("tab_widget_width", ui->tab_widget->width());
+    if (tests.isEmpty()) {
+        statusBar()->showMessage("There are no tests for this problem", STATUS_MESSAGE_MS);
+        return false;
+    }
 
-    settings.setValue("terminal_height", ui->terminal->height());
-    settings.setValue("tab_widget_height", ui->tab_widget->height());
+    return true;
+}
 
-    if (is_folder_opened) {
-        settings.setValue("folder", get_opened_folder());
-    } else {
-        settings.setValue("folder", "-");
+// tests belong to the loaded problem, or to the source file if there is none
+std::optional<QString> MainWindow::test_store_key() const {
+    // titles repeat across sources and may be missing, the URL doesn't
+    if (current_problem.has_value() && !current_problem->url.isEmpty()) {
+        return "problem:" + current_problem->url;
+    }
+    if (current_problem.has_value() && !current_problem->title.isEmpty()) {
+        return "problem:" + current_problem->title;
     }
 
-    // tab-to-file
-    QString opened_tabs_str;
-    const int tabs_amount = ui->tab_widget->count();
-    for (int i = 0; i < tabs_amount; ++i) {
-        const auto tab_editor = get_tab_editor(i);
-        const auto tab_name = ui->tab_widget->tabText(i);
-        const auto tab_file = tab_editor->get_file_name();
+    const CodeEditor *cur_editor = get_cur_editor();
+    if (cur_editor != nullptr && cur_editor->get_file_name().has_value()) {
+        return "file:" + TabRegistry::canonical_path(cur_editor->get_file_name().value());
+    }
 
-        opened_tabs_str += tab_name + ':';
+    return std::nullopt;
+}
 
-        if (tab_file.has_value()) {
-            opened_tabs_str += tab_file.value() + ';';
-        } else {
-            opened_tabs_str += "-;";
-        }
+void MainWindow::start_compile(AfterBuild after) {
+    const auto cur_editor = get_cur_editor();
+    if (cur_editor == nullptr || !cur_editor->get_file_name().has_value()) {
+        statusBar()->showMessage("Save the file before compiling", STATUS_MESSAGE_MS);
+        return;
     }
 
-    settings.setValue("opened_tabs", opened_tabs_str);
+    test_source = cur_editor->get_file_name().value();
+    start_build({build_job(test_source)}, after);
+}
 
-    settings.beginGroup("compiler");
-    settings.setValue("compiler_path", preferences.compiler_path);
-    settings.setValue("compiler_args", preferences.compiler_args);
-    settings.endGroup();
+void MainWindow::start_build(const QVector<BuildJob> &jobs, AfterBuild after) {
+    if (build_runner->is_running()) {
+        return;
+    }
 
-    settings.beginGroup("view");
-    
-    write_font_to_settings("editor_font", preferences.editor_font, settings);
+    build_queue = jobs;
+    after_build = after;
 
-    settings.endGroup();
+    // messages of the previous build no longer apply
+    diagnostics_panel->reset();
+    build_diagnostics.clear();
+    for (CodeEditor *editor : tab_registry.editors()) {
+        editor->set_diagnostics({});
+    }
 
-    
-    // setup shortcuts
-    settings.beginGroup("shortcuts");
+    build_next();
+}
 
-    // file shortcuts
-    settings.beginGroup("file");
+void MainWindow::build_next() {
+    const BuildJob job = build_queue.takeFirst();
+    const QString &file_name = job.source;
+    const QStringList compiler_args = compiler_arguments(job.profile);
 
-    settings.setValue("open", preferences.shortcuts[ShortcutType::FILE_OPEN].toString());
-    settings.setValue("save", preferences.shortcuts[ShortcutType::FILE_SAVE].toString());    
+    build_output = executable_path(file_name, job.profile);
+    build_cache_key = BuildCache::key(file_name, preferences.compiler_path, compiler_args);
 
-    settings.endGroup();
-    // folder shortcuts
-    settings.beginGroup("folder");
+    if (build_cache_key.has_value() && BuildCache::fetch(build_cache_key.value(), build_output)) {
+        BuildResult result;
+        result.started = true;
+        result.cached = true;
+        result.exit_code = 0;
 
-    settings.setValue("open", preferences.shortcuts[ShortcutType::FOLER_OPEN].toString());
+        build_finished(result);
+        return;
+    }
+
+    // the precompiled header only speeds things up, so the cache key doesn't include it
+    QStringList arguments = compiler_args;
+    arguments << pch_builder->include_arguments(preferences.compiler_path, compiler_args);
+    arguments << file_name << "-o" << build_output;
+
+    pch_builder->prepare(preferences.compiler_path, compiler_args);
+
+    ++build_id;
+    QMetaObject::invokeMethod(diagnostic_parser, [parser = diagnostic_parser, id = build_id, dir = QFileInfo(file_name).absolutePath()] () {
+        parser->start(id, dir);
+    });
+
+    ui->terminal->printOutput(("\n$ " + preferences.compiler_path + ' ' + arguments.join(' ') + '\n').toUtf8());
+    statusBar()->showMessage("Compiling " + QFileInfo(file_name).fileName() + " (" + job.profile.name + ")...");
+
+    build_runner->start(BuildStep::COMPILE, preferences.compiler_path, arguments, QFileInfo(file_name).absolutePath());
+}
+
+void MainWindow::build_finished(const BuildResult &result) {
+    if (!result.cached) {
+        QMetaObject::invokeMethod(diagnostic_parser, [parser = diagnostic_parser, id = build_id] () {
+            parser->finish(id);
+        });
+    }
+
+    QString summary;
+    if (result.cached) {
+        summary = "up to date, reused the cached binary";
+    } else if (!result.started) {
+        summary = "failed to start: " + result.error;
+    } else if (result.crashed) {
+        summary = "crashed";
+    } else {
+        summary = "exit code " + QString::number(result.exit_code);
+    }
+
+    if (result.started && !result.cached) {
+        summary += ", wall " + QString::number(result.wall_time_ms) + " ms"
+                 + ", cpu " + QString::number(result.cpu_time_ms) + " ms";
+    }
+
+    if (result.success() && !result.cached && build_cache_key.has_value()) {
+        BuildCache::store(build_cache_key.value(), build_output);
+    }
+
+    ui->terminal->printOutput(("[compile] " + summary + '\n').toUtf8());
+    statusBar()->showMessage((result.success() ? "Compiled: " : "Compilation failed: ") + summary, STATUS_MESSAGE_MS);
+
+    if (!result.success()) {
+        build_queue.clear();
+        return;
+    }
+
+    if (!build_queue.isEmpty()) {
+        build_next();
+        return;
+    }
+
+    switch (after_build) {
+        case AfterBuild::EXECUTE:
+            execute();
+            break;
+        case AfterBuild::TEST:
+            run_stored_tests({file_profile(test_source)});
+            break;
+        case AfterBuild::COMPARE:
+            run_stored_tests(preferences.build_profiles);
+            break;
+        case AfterBuild::STRESS:
+            start_stress();
+            break;
+        case AfterBuild::PROFILE:
+            start_profile();
+            break;
+        case AfterBuild::NOTHING:
+            break;
+    }
+}
+
+// binaries of every profile live side by side, so switching doesn't overwrite one another
+QString MainWindow::executable_path(const QString &file_name, const BuildProfile &profile) const {
+    const QFileInfo info(file_name);
+    return info.absolutePath() + '/' + info.baseName() + '-' + profile.slug();
+}
+
+QStringList MainWindow::compiler_arguments(const BuildProfile &profile) const {
+    return QProcess::splitCommand(preferences.compiler_args) + QProcess::splitCommand(profile.compiler_args);
+}
+
+// the problem's limits for a binary built with the profile
+RunLimits MainWindow::run_limits(const BuildProfile &profile) const {
+    RunLimits limits = current_problem.has_value() ? TestRunner::problem_limits(current_problem.value()) : RunLimits();
+    limits.sanitized = compiler_arguments(profile).join(' ').contains("-fsanitize");
+
+    return limits;
+}
+
+BuildProfile MainWindow::file_profile(const QString &file_name) const {
+    const QString name = file_profiles.value(TabRegistry::canonical_path(file_name));
+
+    for (const auto &profile : preferences.build_profiles) {
+        if (profile.name == name) {
+            return profile;
+        }
+    }
+
+    return preferences.build_profiles.first();
+}
+
+MainWindow::BuildJob MainWindow::build_job(const QString &file_name) const {
+    return {file_name, file_profile(file_name)};
+}
+
+void MainWindow::run_stored_tests(const QVector<BuildProfile> &profiles) {
+    // one row per test and profile, every profile keeps its own outputs
+    test_rows.clear();
+
+    QStringList names;
+    for (const auto &profile : profiles) {
+        for (TestCase test : tests) {
+            if (profiles.size() > 1) {
+                const QFileInfo output(test.output_file);
+
+                test.name += " [" + profile.name + "]";
+                test.output_file = output.path() + '/' + output.completeBaseName() + '.' + profile.slug() + ".out";
+            }
+
+            test_rows.push_back(test);
+            names << test.name;
+        }
+    }
+
+    test_panel->reset(names);
+    test_dock->show();
+    statusBar()->showMessage("Running " + QString::number(test_rows.size()) + " tests...");
+
+    test_profiles = profiles;
+    test_profile_index = 0;
+
+    run_profile_tests();
+}
+
+// profiles run one after another, so they don't compete for the cores
+void MainWindow::run_profile_tests() {
+    const RunLimits limits = run_limits(test_profiles[test_profile_index]);
+
+    const QString executable = executable_path(test_source, test_profiles[test_profile_index]);
+
+    profile_passed = 0;
+    profile_cpu_time_ms = 0;
+    profile_max_cpu_time_ms = 0;
+
+    test_runner->run(executable, QFileInfo(executable).absolutePath(),
+                     test_rows.mid(test_profile_index * tests.size(), tests.size()), limits);
+}
+
+void MainWindow::show_test_diff(int index) {
+    if (index < 0 || index >= test_rows.size()) {
+        return;
+    }
+
+    DiffViewer *viewer = new DiffViewer(test_rows[index].expected_file, test_rows[index].output_file, this);
+    viewer->setAttribute(Qt::WA_DeleteOnClose);
+    viewer->setWindowTitle(test_rows[index].name);
+    viewer->show();
+}
+
+void MainWindow::test_finished(const TestResult &result) {
+    TestResult row_result = result;
+    row_result.index += test_profile_index * int(tests.size());
+
+    test_panel->set_result(row_result);
+
+    if (result.verdict == Verdict::ACCEPTED) {
+        ++profile_passed;
+    }
+    profile_cpu_time_ms += result.run.cpu_time_ms;
+    profile_max_cpu_time_ms = qMax(profile_max_cpu_time_ms, result.run.cpu_time_ms);
+}
+
+void MainWindow::tests_finished() {
+    if (test_profiles.size() > 1) {
+        ui->terminal->printOutput(("[tests] " + test_profiles[test_profile_index].name + ": "
+                                   + QString::number(profile_passed) + '/' + QString::number(tests.size()) + " passed"
+                                   + ", cpu total " + QString::number(profile_cpu_time_ms) + " ms"
+                                   + ", max " + QString::number(profile_max_cpu_time_ms) + " ms\n").toUtf8());
+    }
+
+    if (++test_profile_index < test_profiles.size()) {
+        run_profile_tests();
+        return;
+    }
+
+    statusBar()->showMessage("Tests: " + test_panel->summary(), STATUS_MESSAGE_MS);
+}
+
+void MainWindow::update_profile_menu() {
+    const CodeEditor *cur_editor = get_cur_editor();
+    const bool has_file = cur_editor != nullptr && cur_editor->get_file_name().has_value();
+
+    profile_menu->setEnabled(has_file);
+    if (!has_file) {
+        return;
+    }
+
+    const QString name = file_profile(cur_editor->get_file_name().value()).name;
+    for (QAction *action : profile_group->actions()) {
+        action->setChecked(action->text() == name);
+    }
+}
+
+void MainWindow::rebuild_profile_menu() {
+    for (QAction *action : profile_group->actions()) {
+        profile_group->removeAction(action);
+        delete action;
+    }
+
+    for (const auto &profile : preferences.build_profiles) {
+        QAction *action = profile_menu->addAction(profile.name);
+        action->setCheckable(true);
+        action->setToolTip(profile.compiler_args);
+        profile_group->addAction(action);
+    }
+
+    update_profile_menu();
+}
+
+void MainWindow::profile_selected(QAction *action) {
+    const CodeEditor *cur_editor = get_cur_editor();
+    if (cur_editor == nullptr || !cur_editor->get_file_name().has_value()) {
+        return;
+    }
+
+    const QString path = TabRegistry::canonical_path(cur_editor->get_file_name().value());
+
+    // only files that differ from the default are remembered
+    if (action->text() == preferences.build_profiles.first().name) {
+        file_profiles.remove(path);
+    } else {
+        file_profiles[path] = action->text();
+    }
+
+    const BuildProfile profile = file_profile(path);
+    pch_builder->prepare(preferences.compiler_path, compiler_arguments(profile));
+    statusBar()->showMessage("Build profile: " + profile.name, STATUS_MESSAGE_MS);
+}
+
+void MainWindow::execute() {
+    const auto cur_editor = get_cur_editor();
+    if (cur_editor == nullptr || !cur_editor->get_file_name().has_value()) {
+        return;
+    }
+
+    // runs in the terminal so the program can be fed input interactively
+    QString executable = executable_path(cur_editor->get_file_name().value(), file_profile(cur_editor->get_file_name().value()));
+    executable.replace('\'', "'\\''");
+    executable = "'" + executable + "'";
+
+    // the shell's ulimit applies the problem's limits to the interactive run
+    if (current_problem.has_value()) {
+        const RunLimits limits = run_limits(file_profile(cur_editor->get_file_name().value()));
+
+        QStringList ulimits;
+        if (limits.cpu_time_ms) {
+            ulimits << "-t " + QString::number((limits.cpu_time_ms + 999) / 1000);
+        }
+        // sanitizers reserve far more address space than any limit for their shadow memory
+        if (limits.memory_kb && !limits.sanitized) {
+            ulimits << "-v " + QString::number(limits.memory_kb);
+        }
+
+        if (!ulimits.isEmpty()) {
+            executable = "sh -c 'ulimit " + ulimits.join(' ') + "; exec \"$0\"' " + executable;
+        }
+    }
+
+    ui->terminal->runCommand(executable + "\n");
+}
+
+void MainWindow::terminal_focus() {
+    const bool has_focus = ui->terminal->hasFocus();
+    const auto ind_in_splitter = ui->terminal_splitter->indexOf(ui->terminal);
+    auto sizes = ui->terminal_splitter->sizes();
+
+    if (has_focus) {
+        prev_terminal_height = ui->terminal->height();
+
+        sizes[ind_in_splitter] = 0;
+
+        ui->terminal->clearFocus();
+
+    } else {
+        if (!sizes[ind_in_splitter] && ind_in_splitter && prev_terminal_height <= sizes[ind_in_splitter - 1]) {
+            sizes[ind_in_splitter-1] -= prev_terminal_height; // possible undefined behaviour (ind_in_splitter < 0 or prev_terminal_height > sizes[in...])
+            sizes[ind_in_splitter] = prev_terminal_height;\
+        }
+        ui->terminal->show();
+        ui->terminal->setFocus(Qt::FocusReason::ShortcutFocusReason);
+    }
+    
+    ui->terminal_splitter->setSizes(sizes);
+}
+
+void MainWindow::editor_focus() {
+    get_cur_editor()->setFocus(Qt::FocusReason::MouseFocusReason);
+}
+
+void MainWindow::folder_focus() {
+    ui->tree_view->setFocus(Qt::FocusReason::ShortcutFocusReason);
+}
+
+// the fields the problem service sends are named after the Problem members
+static Problem problem_from_json(const QJsonObject &object) {
+    Problem problem;
+    problem.title = object["title"].toString();
+    problem.time_limit_ms = object["time_limit_ms"].toInt();
+    problem.memory_limit = object["memory_limit"].toString();
+    problem.input_file = object["input_file"].toString();
+    problem.output_file = object["output_file"].toString();
+
+    const QJsonArray examples = object["examples"].toArray();
+    for (const auto &value : examples) {
+        const QJsonObject example = value.toObject();
+        problem.examples.push_back({example["input"].toString(), example["output"].toString()});
+    }
+
+    return problem;
+}
+
+void MainWindow::load_problem()
+{
+    bool ok;
+    ProblemInputDialog dialog;
+    dialog.exec();
+
+    if (dialog.result() == QDialog::Rejected) 
+    {
+        return;
+    }
+
+    QNetworkAccessManager *network_access_manager = new QNetworkAccessManager;
+    connect(network_access_manager, &QNetworkAccessManager::finished, [=] (QNetworkReply *reply)
+    {
+        if (reply->error() != QNetworkReply::NoError)
+        {
+            qWarning() << "Error:" << reply->errorString();
+            reply->deleteLater();
+            return;
+        }
+
+            // Read the data from the reply
+        QByteArray responseData = reply->readAll();
+
+        // Parse the data into a QJsonDocument
+        QJsonDocument jsonDoc = QJsonDocument::fromJson(responseData);
+
+        // Check if the document is valid and is an object
+        if (!jsonDoc.isNull() && jsonDoc.isObject()) {
+            
+            get_cur_editor()->setPlainText("/*" + jsonDoc.toJson() + "*/" + get_cur_editor()->toPlainText());
+
+            current_problem = problem_from_json(jsonDoc.object());
+            current_problem->url = reply->url().toString();
+
+            const std::optional<QString> key = test_store_key();
+            if (key.has_value()) {
+                TestStore(key.value()).set_samples(current_problem->examples);
+            }
+        } else {
+            qWarning() << "Failed to create JSON object.";
+        }
+
+        // Clean up
+        reply->deleteLater();
+    });
+
+    QNetworkRequest request(QString("http://127.0.0.1:3000/problem?source=timus&problem_title=2035"));
+    network_access_manager->get(request);
+
+    //TODO: check for correct url
+}
+
+void MainWindow::start_comp()
+{
+    
+}
+
+void MainWindow::open_preferences() {
+    PreferencesDialog *preferences_dialog = new PreferencesDialog(&preferences);
+    preferences_dialog->setAttribute(Qt::WA_DeleteOnClose);
+
+    // compiler flags may have changed, so the matching header gets built ahead of the next compile
+    connect(preferences_dialog, &QObject::destroyed, this, [this] () {
+        rebuild_profile_menu();
+        pch_builder->prepare(preferences.compiler_path, compiler_arguments(preferences.build_profiles.first()));
+    });
+
+    preferences_dialog->show();
+}
+
+void MainWindow::ask_open_folder() {
+    const QString folder_path = QFileDialog::getExistingDirectory(this, "Open folder", "");
+    if (folder_path.isEmpty()) {
+        return;
+    }
+
+    open_folder(folder_path);
+
+    
+}
+
+void MainWindow::show_folder_context_menu(const QPoint &point) const {
+    folder_context_menu->exec(ui->tree_view->viewport()->mapToGlobal(point));
+
+}
+
+void MainWindow::tab_activated(int index)
+{
+    if (restoring_session) {
+        return; // only the final current tab is materialized
+    }
+
+    CodeEditor *editor = get_tab_editor(index);
+    if (editor == nullptr) {
+        return;
+    }
+
+    tab_lru.removeAll(editor);
+    tab_lru.prepend(editor);
+
+    materialize_tab(editor);
+    evict_tabs();
+
+    update_profile_menu();
+
+    schedule_session_write();
+}
+
+void MainWindow::materialize_tab(CodeEditor *editor)
+{
+    if (!editor->is_unloaded() || editor->is_loading()) {
+        return;
+    }
+
+    if (editor->has_unloaded_buffer() || !editor->get_file_name().has_value()) {
+        editor->restore_from_buffer();
+        return;
+    }
+
+    editor->setup_highlighter();
+    load_file_async(editor, editor->get_file_name().value());
+}
+
+void MainWindow::evict_tabs()
+{
+    tab_lru.removeAll(QPointer<CodeEditor>()); // closed tabs
+
+    qint64 total = 0;
+    for (int i = 0; i < ui->tab_widget->count(); ++i) {
+        total += get_tab_editor(i)->memory_estimate();
+    }
+
+    const CodeEditor *cur_editor = get_cur_editor();
+
+    // least recently used tabs go first, the visible one always stays
+    for (auto it = tab_lru.rbegin(); it != tab_lru.rend() && total > preferences.tab_memory_budget; ++it) {
+        CodeEditor *editor = *it;
+        if (editor == cur_editor || editor->is_unloaded()) {
+            continue;
+        }
+
+        const qint64 estimate = editor->memory_estimate();
+        editor->unload();
+
+        if (editor->is_unloaded()) {
+            total -= estimate;
+        }
+    }
+}
+
+int MainWindow::take_untitled_id() {
+    int id = 1;
+    while (untitled_ids.contains(id)) {
+        ++id;
+    }
+
+    untitled_ids.insert(id);
+    return id;
+}
+
+QString MainWindow::tab_name(CodeEditor *editor) const {
+    if (editor->get_file_name().has_value()) {
+        return QFileInfo(editor->get_file_name().value()).fileName();
+    }
+
+    const int untitled_id = tab_infos.value(editor).untitled_id;
+
+    QString name = "Untitled";
+    if (untitled_id > 1) {
+        name += " (" + QString::number(untitled_id) + ')';
+    }
+
+    return name;
+}
+
+void MainWindow::update_tab_title(CodeEditor *editor) {
+    const int tab_ind = ui->tab_widget->indexOf(editor);
+    if (tab_ind < 0) {
+        return;
+    }
+
+    const TabInfo info = tab_infos.value(editor);
+
+    QString title = tab_name(editor);
+
+    if (info.load_percent >= 0) {
+        title += " (" + QString::number(info.load_percent) + "%)";
+    }
+
+    if (info.dirty) {
+        title += " *";
+    }
+
+    ui->tab_widget->setTabText(tab_ind, title);
+}
+
+void MainWindow::open_file(const QString &file_name, bool activate) {
+    CodeEditor *opened_editor = tab_registry.find(file_name);
+    if (opened_editor != nullptr) {
+        if (activate) {
+            ui->tab_widget->setCurrentWidget(opened_editor);
+        }
+        return;
+    }
+
+    QFile file(file_name);
+
+    if (!file.open(QIODevice::ReadOnly)) {
+        // a file of the last session that has vanished isn't worth a dialog
+        if (!restoring_session) {
+            QMessageBox::critical(this, "Error", "Can't open file", QMessageBox::Ok);
+        }
+        return;
+    }
+
+    if (file.size() > preferences.large_file_size) {
+        file.close();
+        open_large_file(file_name);
+        return;
+    }
+
+    file.close();
+
+    auto editor = add_editor_tab(activate);
+
+    set_editor_file(editor, file_name);
+
+    if (!activate) {
+        editor->unload(); // read from disk once the tab is first shown
+        return;
+    }
+
+    load_file_async(editor, file_name);
+}
+
+void MainWindow::load_file_async(CodeEditor *editor, const QString &file_name) {
+    QThread *thread = new QThread;
+    FileLoader *loader = new FileLoader(file_name);
+    loader->moveToThread(thread);
+
+    const QString tab_name = QFileInfo(file_name).fileName();
+
+    editor->set_loading(true);
+
+    tab_infos[editor].load_percent = 0;
+    update_tab_title(editor);
+
+    connect(loader, &FileLoader::chunk_loaded, editor, [this, editor] (const QString &text, int percent) {
+        QTextCursor cursor(editor->document());
+        cursor.movePosition(QTextCursor::End);
+        cursor.insertText(text);
+
+        tab_infos[editor].load_percent = percent;
+        update_tab_title(editor);
+    });
+
+    connect(loader, &FileLoader::finished, editor, [this, editor, file_name] () {
+        editor->set_loading(false);
+        editor->document()->setModified(false);
+        editor->set_diagnostics(build_diagnostics.value(TabRegistry::canonical_path(file_name)));
+
+        if (editor->is_unloaded()) {
+            editor->restore_view_state();
+        } else {
+            editor->moveCursor(QTextCursor::Start);
+        }
+
+        if (pending_location.has_value() && pending_location->editor == editor) {
+            editor->go_to(pending_location->line, pending_location->column);
+            pending_location.reset();
+        }
+
+        tab_infos[editor].load_percent = -1;
+        tab_infos[editor].dirty = false;
+        update_tab_title(editor);
+
+        if (editor == get_cur_editor()) {
+            log_startup_interactive();
+        }
+
+        evict_tabs();
+    });
+
+    connect(loader, &FileLoader::failed, editor, [this, editor, tab_name] (const QString &error) {
+        editor->set_loading(false);
+        editor->document()->setModified(false);
+
+        tab_infos[editor].load_percent = -1;
+        tab_infos[editor].dirty = false;
+        update_tab_title(editor);
+
+        QMessageBox::critical(this, "Error", "Can't read file " + tab_name + '\n' + error, QMessageBox::Ok);
+    });
+
+    connect(thread, &QThread::started, loader, &FileLoader::load);
+    connect(loader, &FileLoader::finished, thread, &QThread::quit);
+    connect(loader, &FileLoader::failed, thread, &QThread::quit);
+    connect(thread, &QThread::finished, loader, &QObject::deleteLater);
+    connect(thread, &QThread::finished, thread, &QObject::deleteLater);
+
+    // stop reading if the tab is closed mid-load
+    connect(editor, &QObject::destroyed, thread, &QThread::requestInterruption);
+
+    thread->start();
+}
+
+void MainWindow::open_large_file(const QString &file_name) {
+    const bool read_only = QFileInfo(file_name).size() > preferences.read_only_file_size;
+
+    open_new_tab();
+
+    auto cur_editor = get_cur_editor();
+
+    if (!cur_editor->open_large_file(file_name, read_only)) {
+        ui->tab_widget->removeTab(ui->tab_widget->currentIndex());
+        cur_editor->deleteLater();
+        if (!restoring_session) {
+            QMessageBox::critical(this, "Error", "Can't open file", QMessageBox::Ok);
+        }
+        return;
+    }
+
+    set_editor_file(cur_editor, file_name);
+
+    const int cur_tab_ind = ui->tab_widget->currentIndex();
+
+    if (read_only) {
+        ui->tab_widget->setTabToolTip(cur_tab_ind, "Opened read-only: the file is too large to edit");
+    }
+}
+
+void MainWindow::save_file(CodeEditor *cur_editor, const QString &file_name) {
+
+    if (cur_editor->is_loading()) {
+        return; // saving now would write a truncated file
+    }
+
+    if (cur_editor->is_large_file() && cur_editor->isReadOnly()) {
+        QMessageBox::critical(this, "Error", "Can't save file", QMessageBox::Ok);
+        return;
+    }
+
+    // the modified marker is cleared once the write has reached the disk
+    set_editor_file(cur_editor, file_name);
+
+    const quint64 id = next_save_id++;
+    pending_saves.insert(id, {cur_editor, cur_editor->save_revision()});
+
+    FileSaver *saver = file_saver;
+
+    if (cur_editor->is_large_file()) {
+        const PieceTable pieces = cur_editor->large_file_snapshot();
+        QMetaObject::invokeMethod(saver, [saver, id, file_name, pieces] () {
+            saver->save_pieces(id, file_name, pieces);
+        });
+        return;
+    }
+
+    // the snapshot is taken here, encoding and writing happen on the save thread
+    const QString contents = cur_editor->toPlainText();
+    QMetaObject::invokeMethod(saver, [saver, id, file_name, contents] () {
+        saver->save(id, file_name, contents);
+    });
+}
+
+void MainWindow::file_saved(quint64 id) {
+    const PendingSave pending = pending_saves.take(id);
+    CodeEditor *editor = pending.editor;
+
+    if (editor == nullptr) {
+        return; // tab was closed meanwhile
+    }
+
+    // QSaveFile replaced the file, so its inode changed
+    if (editor->get_file_name().has_value()) {
+        tab_registry.add(editor, editor->get_file_name().value());
+    }
+
+    // edits made while the save was running keep the tab modified
+    if (editor->save_revision() != pending.revision) {
+        return;
+    }
+
+    editor->document()->setModified(false);
+}
+
+void MainWindow::file_changed_on_disk(const QString &file_name) {
+    CodeEditor *editor = tab_registry.find(file_name);
+    if (editor == nullptr) {
+        return;
+    }
+
+    // an external save usually replaces the file, and with it the inode
+    tab_registry.refresh(editor);
+
+    // unloaded tabs are re-read when shown, edited ones are never overwritten
+    if (editor->is_loading() || editor->is_unloaded() || editor->is_large_file()
+        || editor->document()->isModified()) {
+        return;
+    }
+
+    // our own save is still on its way to the disk
+    for (const auto &pending : std::as_const(pending_saves)) {
+        if (pending.editor == editor) {
+            return;
+        }
+    }
+
+    QFile file(file_name);
+    if (!file.open(QIODevice::ReadOnly) || file.size() > preferences.large_file_size) {
+        return;
+    }
+
+    editor->replace_contents(QString::fromUtf8(file.readAll()));
+    editor->document()->setModified(false);
+}
+
+void MainWindow::file_save_failed(quint64 id, QString error) {
+    const PendingSave pending = pending_saves.take(id);
+
+    QString file_name;
+    if (pending.editor != nullptr && pending.editor->get_file_name().has_value()) {
+        file_name = QFileInfo(pending.editor->get_file_name().value()).fileName();
+    }
+
+    QMessageBox::critical(this, "Error", "Can't save file " + file_name + '\n' + error, QMessageBox::Ok);
+}
+
+void MainWindow::open_folder(const QString &folder_name) {
+    if (!is_folder_opened) {
+        ui->tree_view->setModel(fs_model);
+        is_folder_opened = true;
+
+        ui->tree_view->setHeaderHidden(true);
+        for (int i = 1; i < fs_model->columnCount(); ++i) {
+            ui->tree_view->setColumnHidden(i, true);
+        }
+    }
+
+    ui->tree_view->setRootIndex(fs_model->index(folder_name));
+    ui->terminal->setDirectory(folder_name);
+
+    is_folder_opened = true;
+}
+
+QString MainWindow::get_opened_folder() const {
+    return fs_model->fileInfo(ui->tree_view->rootIndex()).absoluteFilePath();
+}
+
+void MainWindow::write_settings() {
+    QSettings settings(QApplication::organizationName(), QApplication::applicationName());
+
+    settings.setValue("tree_view_width", ui->tree_view->width());
+    settings.setValue("tab_widget_width", ui->tab_widget->width());
+
+    settings.setValue("terminal_height", ui->terminal->height());
+    settings.setValue("tab_widget_height", ui->tab_widget->height());
+
+    // closing before the deferred restore ran must not wipe the saved session
+    if (session_restored) {
+        if (is_folder_opened) {
+            settings.setValue("folder", get_opened_folder());
+        } else {
+            settings.setValue("folder", "-");
+        }
+
+        // tabs live in the session file now
+        settings.remove("opened_tabs");
+    }
+
+    settings.beginGroup("compiler");
+    settings.setValue("compiler_path", preferences.compiler_path);
+    settings.setValue("compiler_args", preferences.compiler_args);
+
+    settings.beginWriteArray("profiles", preferences.build_profiles.size());
+    for (int i = 0; i < preferences.build_profiles.size(); ++i) {
+        settings.setArrayIndex(i);
+        settings.setValue("name", preferences.build_profiles[i].name);
+        settings.setValue("args", preferences.build_profiles[i].compiler_args);
+    }
+    settings.endArray();
+
+    QVariantMap profiles_by_file;
+    for (auto it = file_profiles.cbegin(); it != file_profiles.cend(); ++it) {
+        profiles_by_file[it.key()] = it.value();
+    }
+    settings.setValue("file_profiles", profiles_by_file);
+    settings.endGroup();
+
+    settings.beginGroup("files");
+    settings.setValue("large_file_mb",     preferences.large_file_size / (1024 * 1024));
+    settings.setValue("read_only_file_mb", preferences.read_only_file_size / (1024 * 1024));
+    settings.setValue("tab_memory_budget_mb", preferences.tab_memory_budget / (1024 * 1024));
+    settings.endGroup();
+
+    settings.beginGroup("view");
+    
+    write_font_to_settings("editor_font", preferences.editor_font, settings);
+
+    settings.endGroup();
+
+    
+    // setup shortcuts
+    settings.beginGroup("shortcuts");
+
+    // file shortcuts
+    settings.beginGroup("file");
+
+    settings.setValue("open", preferences.shortcuts[ShortcutType::FILE_OPEN].toString());
+    settings.setValue("save", preferences.shortcuts[ShortcutType::FILE_SAVE].toString());    
+
+    settings.endGroup();
+    // folder shortcuts
+    settings.beginGroup("folder");
+
+    settings.setValue("open", preferences.shortcuts[ShortcutType::FOLER_OPEN].toString());
 
     settings.endGroup();
 
@@ -572,6 +1590,8 @@ void MainWindow::write_settings() {
 
     settings.setValue("compile", preferences.shortcuts[ShortcutType::RUN_COMPILE].toString());
     settings.setValue("exec", preferences.shortcuts[ShortcutType::RUN_EXEC].toString());
+    settings.setValue("compile_exec", preferences.shortcuts[ShortcutType::RUN_COMPILE_EXEC].toString());
+    settings.setValue("tests", preferences.shortcuts[ShortcutType::RUN_TESTS].toString());
 
     settings.endGroup();
 
@@ -601,47 +1621,44 @@ void MainWindow::read_settings() {
     ui->folder_editor_splitter->setSizes({tree_view_width, tab_widget_width});
     ui->terminal_splitter->setSizes({tab_widget_height, terminal_height});
 
-    // setup folder
-    const QString folder = settings.value("folder", "-").toString();
-    if (folder != "-") {
-        open_folder(folder);
-    }
-
-    // setup opened tabs
-    const QStringList opened_tabs = settings.value("opened_tabs", "").toString().split(';');
-    for (const auto opened_tab: opened_tabs) {
-        const auto opened_tab_split = opened_tab.split(':');
-
-        if (opened_tab_split.size() != 2) {
-            continue;
-        }
-
-        const auto tab_name = opened_tab_split[0];
-        const auto file_name = opened_tab_split[1];
-
-        if (file_name != "-") {
-            open_file(file_name);
-        } else {
-            open_new_tab();
-        }
+    // setup file handling
+    settings.beginGroup("files");
+    preferences.large_file_size     = settings.value("large_file_mb", 32).toLongLong() * 1024 * 1024;
+    preferences.read_only_file_size = settings.value("read_only_file_mb", 512).toLongLong() * 1024 * 1024;
+    preferences.tab_memory_budget   = settings.value("tab_memory_budget_mb", 256).toLongLong() * 1024 * 1024;
+    settings.endGroup();
 
-        ui->tab_widget->setTabText(ui->tab_widget->count() - 1, tab_name); 
-    }
 
     // setup compiler settings
     settings.beginGroup("compiler");
     preferences.compiler_path = settings.value("compiler_path", "/usr/bin/gcc").toString();
-    preferences.compiler_args = settings.value("compiler_args", "-Wall -Wextra -O2").toString();
+    preferences.compiler_args = settings.value("compiler_args", "-Wall -Wextra").toString();
+
+    const int profile_count = settings.beginReadArray("profiles");
+    for (int i = 0; i < profile_count; ++i) {
+        settings.setArrayIndex(i);
+        preferences.build_profiles.push_back({settings.value("name").toString(), settings.value("args").toString()});
+    }
+    settings.endArray();
+
+    if (preferences.build_profiles.isEmpty()) {
+        preferences.build_profiles = {
+            {"Release", "-O2"},
+            {"Debug", "-O0 -g -fsanitize=address,undefined"},
+            {"Native", "-O3 -march=native"}
+        };
+    }
+
+    const QVariantMap profiles_by_file = settings.value("file_profiles").toMap();
+    for (auto it = profiles_by_file.cbegin(); it != profiles_by_file.cend(); ++it) {
+        file_profiles[it.key()] = it.value().toString();
+    }
     settings.endGroup();
 
     settings.beginGroup("view");
 
     preferences.editor_font = read_font_from_settings("editor_font", settings, this->font());
 
-    for (int tab_ind = 0; tab_ind < ui->tab_widget->count(); ++tab_ind) {
-        ui->tab_widget->widget(tab_ind)->setFont(preferences.editor_font);
-    }
-
     settings.endGroup();
 
     // setup shortcuts
@@ -666,6 +1683,8 @@ void MainWindow::read_settings() {
 
     preferences.shortcuts[ShortcutType::RUN_COMPILE] = settings.value("compile", "Ctrl+F9").toString();
     preferences.shortcuts[ShortcutType::RUN_EXEC] = settings.value("exec", "Shift+F10").toString();
+    preferences.shortcuts[ShortcutType::RUN_COMPILE_EXEC] = settings.value("compile_exec", "F9").toString();
+    preferences.shortcuts[ShortcutType::RUN_TESTS] = settings.value("tests", "Ctrl+F10").toString();
 
     settings.endGroup();
 
@@ -688,6 +1707,8 @@ void MainWindow::read_settings() {
 
     ui->compile_action->setShortcut(preferences.shortcuts[ShortcutType::RUN_COMPILE]);
     ui->exec_action->setShortcut(preferences.shortcuts[ShortcutType::RUN_EXEC]);
+    ui->compile_exec_action->setShortcut(preferences.shortcuts[ShortcutType::RUN_COMPILE_EXEC]);
+    ui->run_tests_action->setShortcut(preferences.shortcuts[ShortcutType::RUN_TESTS]);
 
     ui->close_tab_action->setShortcut(preferences.shortcuts[ShortcutType::TAB_CLOSE]);
     ui->new_tab_action->setShortcut(preferences.shortcuts[ShortcutType::TAB_NEW]);
@@ -695,12 +1716,278 @@ void MainWindow::read_settings() {
     ui->prev_tab_action->setShortcut(preferences.shortcuts[ShortcutType::TAB_PREV]);
 }
 
+void MainWindow::restore_session() {
+    // scheduled by the first paint and by the fallback timer, whichever comes first
+    if (restoring_session || session_restored) {
+        return;
+    }
+
+    QSettings settings(QApplication::organizationName(), QApplication::applicationName());
+
+    // every tab is created unloaded, only the active one is read right away
+    restoring_session = true;
+
+    int current_tab = -1;
+
+    const std::optional<Session> session = SessionStore::read(SessionStore::default_path());
+    if (session.has_value()) {
+        for (const auto &tab : session->tabs) {
+            restore_session_tab(tab);
+        }
+
+        current_tab = session->current_tab;
+    } else {
+        // sessions written before the session file existed
+        const QStringList opened_tabs = settings.value("opened_tabs", "").toString().split(';');
+        for (const auto opened_tab: opened_tabs) {
+            const auto opened_tab_split = opened_tab.split(':');
+
+            if (opened_tab_split.size() != 2) {
+                continue;
+            }
+
+            const auto tab_name = opened_tab_split[0];
+            const auto file_name = opened_tab_split[1];
+
+            if (file_name != "-") {
+                open_file(file_name, false);
+            } else {
+                restore_untitled_id(add_editor_tab(false), tab_name);
+            }
+        }
+    }
+
+    recover_journals();
+
+    restoring_session = false;
+    session_restored = true;
+
+    const int tabs_amount = ui->tab_widget->count();
+    if (tabs_amount) {
+        if (current_tab < 0 || current_tab >= tabs_amount) {
+            current_tab = tabs_amount - 1;
+        }
+
+        ui->tab_widget->setCurrentIndex(current_tab);
+        tab_activated(ui->tab_widget->currentIndex());
+    }
+
+    const CodeEditor *cur_editor = get_cur_editor();
+    if (cur_editor == nullptr || !cur_editor->is_loading()) {
+        log_startup_interactive();
+    }
+
+    // the precompiled header is built by the compiler in the background
+    QTimer::singleShot(0, this, [this] () {
+        pch_builder->prepare(preferences.compiler_path, compiler_arguments(preferences.build_profiles.first()));
+    });
+
+    // the folder model walks the file system, so it goes last
+    const QString folder = settings.value("folder", "-").toString();
+    if (folder != "-") {
+        QTimer::singleShot(0, this, [this, folder] () {
+            open_folder(folder);
+        });
+    }
+}
+
+void MainWindow::restore_session_tab(const SessionTab &tab) {
+    if (tab.file_name.has_value() && tab_registry.contains(tab.file_name.value())) {
+        return;
+    }
+
+    bool modified = tab.modified;
+    std::optional<QByteArray> buffer;
+    if (tab.modified || !tab.file_name.has_value()) {
+        buffer = tab.buffer;
+    }
+
+    // a journal left behind by a crash is newer than the session file
+    bool journal_recovered = false;
+    if (tab.journal_id) {
+        const std::optional<RecoveredBuffer> recovered = Journal::replay(tab.journal_id);
+        if (recovered.has_value()) {
+            buffer = qCompress(recovered->text.toUtf8());
+            modified = true;
+            journal_recovered = true;
+        }
+    }
+
+    CodeEditor *editor;
+    if (!tab.file_name.has_value()) {
+        editor = add_editor_tab(false);
+        restore_untitled_id(editor, tab.name);
+    } else if (modified) {
+        // the unsaved text is all that matters, even if the file is gone or
+        // has grown past the large file size meanwhile
+        editor = add_editor_tab(false);
+        set_editor_file(editor, tab.file_name.value());
+    } else {
+        const int tabs_amount = ui->tab_widget->count();
+        open_file(tab.file_name.value(), false);
+
+        if (ui->tab_widget->count() == tabs_amount) {
+            return; // the file is gone
+        }
+
+        editor = get_tab_editor(tabs_amount);
+        if (editor->is_large_file()) {
+            return; // mapped from disk, there's no view state to restore
+        }
+    }
+
+    if (journal_recovered) {
+        editor->get_journal()->adopt(tab.journal_id);
+    }
+
+    editor->restore_unloaded(tab.cursor_position, tab.scroll_position, modified, buffer);
+}
+
+void MainWindow::restore_untitled_id(CodeEditor *editor, const QString &tab_name) {
+    static const QRegularExpression untitled_regexp("^Untitled(?: \\((\\d+)\\))?( \\*)?$");
+
+    const auto match = untitled_regexp.match(tab_name);
+    if (!match.hasMatch()) {
+        return;
+    }
+
+    const int id = match.captured(1).isEmpty() ? 1 : match.captured(1).toInt();
+    if (untitled_ids.contains(id)) {
+        return; // keep the freshly assigned one
+    }
+
+    TabInfo &info = tab_infos[editor];
+    untitled_ids.remove(info.untitled_id);
+    untitled_ids.insert(id);
+    info.untitled_id = id;
+
+    update_tab_title(editor);
+}
+
+void MainWindow::recover_journals() {
+    // journals already adopted by restored tabs
+    QSet<quint64> known_journals;
+    for (int i = 0; i < ui->tab_widget->count(); ++i) {
+        known_journals.insert(get_tab_editor(i)->get_journal()->id());
+    }
+
+    for (const quint64 id : Journal::list()) {
+        if (known_journals.contains(id)) {
+            continue;
+        }
+
+        const std::optional<RecoveredBuffer> recovered = Journal::replay(id);
+        if (!recovered.has_value()) {
+            QFile::remove(Journal::file_path(id));
+            continue;
+        }
+
+        // buffers that never made it into the session file get their own tab
+        CodeEditor *editor = add_editor_tab(false);
+
+        if (recovered->file_name.has_value()) {
+            set_editor_file(editor, recovered->file_name.value());
+        }
+
+        editor->restore_unloaded(0, 0, true, qCompress(recovered->text.toUtf8()));
+        editor->get_journal()->adopt(id);
+    }
+}
+
+Session MainWindow::collect_session() {
+    Session session;
+    session.current_tab = ui->tab_widget->currentIndex();
+
+    const int tabs_amount = ui->tab_widget->count();
+    for (int i = 0; i < tabs_amount; ++i) {
+        CodeEditor *editor = get_tab_editor(i);
+
+        SessionTab tab;
+        tab.file_name = editor->get_file_name();
+        tab.cursor_position = editor->cursor_position();
+        tab.scroll_position = editor->scroll_position();
+        tab.journal_id = editor->get_journal()->id();
+
+        tab.name = tab_name(editor);
+
+        if (!editor->is_large_file() && !editor->is_loading()) {
+            tab.modified = editor->document()->isModified();
+
+            if (tab.modified || !tab.file_name.has_value()) {
+                tab.buffer = editor->compressed_contents(); // cached until the document changes
+            }
+        }
+
+        session.tabs.push_back(tab);
+    }
+
+    return session;
+}
+
+void MainWindow::schedule_session_write() {
+    // written at most once per interval while edits keep coming
+    if (session_restored && !session_timer->isActive()) {
+        session_timer->start();
+    }
+}
+
+void MainWindow::write_session() {
+    const Session session = collect_session();
+    const QString session_path = SessionStore::default_path();
+
+    QMetaObject::invokeMethod(file_saver, [session_path, session] () {
+        if (!SessionStore::write(session_path, session)) {
+            qWarning() << "Can't write session file" << session_path;
+        }
+    });
+}
+
+void MainWindow::log_startup_interactive() {
+    if (startup_interactive) {
+        return;
+    }
+
+    startup_interactive = true;
+    qInfo() << "startup: interactive after" << startup_timer.elapsed() << "ms";
+}
+
+bool MainWindow::event(QEvent *event) {
+    const bool result = QMainWindow::event(event);
+
+    // the session is restored only once the empty window is on screen
+    if (event->type() == QEvent::Paint && !first_paint_done) {
+        first_paint_done = true;
+        qInfo() << "startup: first paint after" << startup_timer.elapsed() << "ms";
+
+        QTimer::singleShot(0, this, &MainWindow::restore_session);
+    }
+
+    return result;
+}
+
+void MainWindow::set_editor_file(CodeEditor *editor, const QString &file_name) {
+    if (editor->get_file_name().has_value()) {
+        file_watcher->unwatch(TabRegistry::canonical_path(editor->get_file_name().value()));
+    }
+
+    editor->set_file_name(file_name);
+    tab_registry.add(editor, file_name);
+    file_watcher->watch(TabRegistry::canonical_path(file_name));
+
+    TabInfo &info = tab_infos[editor];
+    untitled_ids.remove(info.untitled_id);
+    info.untitled_id = 0;
+
+    update_tab_title(editor);
+}
+
+// the tab widget only ever holds editors
 CodeEditor* MainWindow::get_cur_editor() const {
-    return dynamic_cast<CodeEditor*>(ui->tab_widget->currentWidget());
+    return static_cast<CodeEditor*>(ui->tab_widget->currentWidget());
 }
 
-CodeEditor* MainWindow::get_tab_editor(uint8_t tab_ind) const {
-    return dynamic_cast<CodeEditor*>(ui->tab_widget->widget(tab_ind));
+CodeEditor* MainWindow::get_tab_editor(int tab_ind) const {
+    return static_cast<CodeEditor*>(ui->tab_widget->widget(tab_ind));
 }
 
 void MainWindow::setup_folder_context_menu() {
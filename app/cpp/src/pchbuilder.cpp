@@ -0,0 +1,154 @@
+#include "pchbuilder.hpp"
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QStandardPaths>
+#include <QDebug>
+
+#include "buildcache.hpp"
+
+PchBuilder::PchBuilder(QObject *parent)
+    : QObject(parent)
+{
+    process = new QProcess(this);
+    process->setProcessChannelMode(QProcess::MergedChannels);
+
+    connect(process, &QProcess::finished, this, &PchBuilder::process_finished);
+    connect(process, &QProcess::errorOccurred, this, [this] (QProcess::ProcessError error) {
+        if (error == QProcess::FailedToStart && !building_key.isEmpty()) {
+            failed_keys.insert(building_key);
+            building_key.clear();
+        }
+    });
+}
+
+QString PchBuilder::directory() {
+    return QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/pch";
+}
+
+void PchBuilder::prepare(const QString &compiler_path, const QStringList &compiler_args) {
+    const QString pch_key = key(compiler_path, compiler_args);
+    if (pch_key.isEmpty() || pch_key == building_key || failed_keys.contains(pch_key)) {
+        return;
+    }
+
+    const QString header = header_path(pch_key);
+    if (QFileInfo::exists(header + ".gch")) {
+        return;
+    }
+
+    // flags changed while the previous header was building, it's useless now;
+    // the new one is started once the killed compiler has been reaped
+    if (process->state() != QProcess::NotRunning) {
+        queued_compiler_path = compiler_path;
+        queued_compiler_args = compiler_args;
+
+        if (!building_key.isEmpty()) {
+            killed_key = building_key;
+            building_key.clear();
+            process->kill();
+        }
+        return;
+    }
+
+    if (!QDir().mkpath(QFileInfo(header).absolutePath())) {
+        return;
+    }
+
+    QFile wrapper(header);
+    if (!wrapper.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        return;
+    }
+    wrapper.write("#include_next <bits/stdc++.h>\n");
+    wrapper.close();
+
+    building_key = pch_key;
+
+    QStringList arguments = compiler_args;
+    arguments << "-x" << "c++-header" << header << "-o" << header + ".gch.tmp";
+
+    qInfo() << "pch: building" << header + ".gch";
+    process->start(compiler_path, arguments);
+}
+
+QStringList PchBuilder::include_arguments(const QString &compiler_path, const QStringList &compiler_args) const {
+    const QString pch_key = key(compiler_path, compiler_args);
+    if (pch_key.isEmpty() || !QFileInfo::exists(header_path(pch_key) + ".gch")) {
+        return {};
+    }
+
+    return {"-I", directory() + '/' + pch_key};
+}
+
+void PchBuilder::process_finished(int exit_code, QProcess::ExitStatus exit_status) {
+    // killed in favour of another combination
+    if (building_key.isEmpty()) {
+        if (!killed_key.isEmpty()) {
+            QFile::remove(header_path(killed_key) + ".gch.tmp");
+            killed_key.clear();
+        }
+
+        if (!queued_compiler_path.isEmpty()) {
+            const QString compiler_path = queued_compiler_path;
+            queued_compiler_path.clear();
+            prepare(compiler_path, queued_compiler_args);
+        }
+        return;
+    }
+
+    const QString pch_key = building_key;
+    building_key.clear();
+
+    const QString header = header_path(pch_key);
+
+    if (exit_status != QProcess::NormalExit || exit_code != 0) {
+        qInfo() << "pch: failed to build" << header + ".gch";
+        failed_keys.insert(pch_key);
+        QFile::remove(header + ".gch.tmp");
+        return;
+    }
+
+    // only a complete header is ever visible to the compile commands
+    QFile::remove(header + ".gch");
+    if (!QFile::rename(header + ".gch.tmp", header + ".gch")) {
+        return;
+    }
+
+    evict(pch_key);
+    emit ready();
+}
+
+QString PchBuilder::key(const QString &compiler_path, const QStringList &compiler_args) {
+    const QByteArray identity = BuildCache::compiler_identity(compiler_path);
+    if (identity.isEmpty()) {
+        return {};
+    }
+
+    QCryptographicHash hash(QCryptographicHash::Sha256);
+    hash.addData(identity);
+    hash.addData(QByteArray(1, '\0'));
+    hash.addData(compiler_args.join(QChar('\0')).toUtf8());
+
+    return QString::fromLatin1(hash.result().toHex().left(32));
+}
+
+QString PchBuilder::header_path(const QString &key) {
+    return directory() + '/' + key + "/bits/stdc++.h";
+}
+
+// keeps the most recently built headers, each one is tens of megabytes
+void PchBuilder::evict(const QString &keep) {
+    QFileInfoList entries = QDir(directory()).entryInfoList(QDir::Dirs | QDir::NoDotAndDotDot, QDir::Time);
+
+    int kept = 0;
+    for (const auto &entry : entries) {
+        if (entry.fileName() == keep || kept++ < MAX_HEADERS - 1) {
+            continue;
+        }
+
+        QDir(entry.filePath()).removeRecursively();
+    }
+}
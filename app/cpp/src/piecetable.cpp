@@ -0,0 +1,264 @@
+#include "piecetable.hpp"
+
+#include <QIODevice>
+
+#include <algorithm>
+#include <cstring>
+
+PieceTable::PieceTable(const char *original, qint64 original_size, std::shared_ptr<const void> owner)
+    : original(original), original_size(original_size), owner(std::move(owner))
+{
+    // one sequential pass builds the sparse line index of the original buffer
+    original_index.push_back(0);
+
+    qint64 breaks = 0;
+    const char *cur = original;
+    const char *end = original + original_size;
+    while (cur < end) {
+        const char *nl = static_cast<const char*>(std::memchr(cur, '\n', end - cur));
+        if (nl == nullptr) {
+            break;
+        }
+
+        ++breaks;
+        cur = nl + 1;
+
+        if (breaks % LINE_INDEX_STEP == 0) {
+            original_index.push_back(cur - original);
+        }
+    }
+
+    if (original_size) {
+        pieces.push_back({false, 0, original_size, breaks});
+    }
+
+    total_size = original_size;
+    total_breaks = breaks;
+}
+
+qint64 PieceTable::line_offset(qint64 line) const {
+    if (line <= 0) {
+        return 0;
+    }
+
+    if (line > total_breaks) {
+        return total_size;
+    }
+
+    qint64 pos = 0;
+    qint64 breaks = 0;
+    for (const auto &piece : pieces) {
+        if (breaks + piece.line_breaks < line) {
+            breaks += piece.line_breaks;
+            pos += piece.length;
+            continue;
+        }
+
+        const qint64 need = line - breaks;
+
+        if (!piece.added) {
+            const qint64 n = original_breaks_before(piece.start) + need;
+            return pos + original_break_end(n) - piece.start;
+        }
+
+        const char *cur = added.constData() + piece.start;
+        for (qint64 found = 0; ; ++cur) {
+            if (*cur == '\n' && ++found == need) {
+                return pos + (cur + 1 - (added.constData() + piece.start));
+            }
+        }
+    }
+
+    return total_size;
+}
+
+QByteArray PieceTable::read(qint64 pos, qint64 len) const {
+    QByteArray result;
+
+    pos = qBound<qint64>(0, pos, total_size);
+    len = qBound<qint64>(0, len, total_size - pos);
+    result.reserve(len);
+
+    qint64 piece_pos = 0;
+    for (const auto &piece : pieces) {
+        if (!len) {
+            break;
+        }
+
+        if (piece_pos + piece.length <= pos) {
+            piece_pos += piece.length;
+            continue;
+        }
+
+        const qint64 from = pos - piece_pos;
+        const qint64 take = qMin(len, piece.length - from);
+        result.append(buffer(piece.added) + piece.start + from, take);
+
+        pos += take;
+        len -= take;
+        piece_pos += piece.length;
+    }
+
+    return result;
+}
+
+void PieceTable::insert(qint64 pos, const QByteArray &bytes) {
+    if (bytes.isEmpty()) {
+        return;
+    }
+
+    pos = qBound<qint64>(0, pos, total_size);
+
+    const qint64 added_start = added.size();
+    added.append(bytes);
+
+    const Piece new_piece = make_piece(true, added_start, bytes.size());
+
+    total_size += new_piece.length;
+    total_breaks += new_piece.line_breaks;
+
+    qint64 piece_pos = 0;
+    for (auto it = pieces.begin(); it != pieces.end(); ++it) {
+        if (pos == piece_pos) {
+            pieces.insert(it, new_piece);
+            return;
+        }
+
+        if (pos < piece_pos + it->length) {
+            const qint64 split = pos - piece_pos;
+            const Piece left = make_piece(it->added, it->start, split);
+            const Piece right = {it->added, it->start + split, it->length - split, it->line_breaks - left.line_breaks};
+
+            *it = left;
+            it = pieces.insert(it + 1, new_piece);
+            pieces.insert(it + 1, right);
+            return;
+        }
+
+        piece_pos += it->length;
+    }
+
+    // appending right after the previous insertion just grows that piece
+    if (!pieces.empty() && pieces.back().added && pieces.back().start + pieces.back().length == added_start) {
+        pieces.back().length += new_piece.length;
+        pieces.back().line_breaks += new_piece.line_breaks;
+        return;
+    }
+
+    pieces.push_back(new_piece);
+}
+
+void PieceTable::remove(qint64 pos, qint64 len) {
+    pos = qBound<qint64>(0, pos, total_size);
+    len = qBound<qint64>(0, len, total_size - pos);
+
+    if (!len) {
+        return;
+    }
+
+    const qint64 end = pos + len;
+
+    std::vector<Piece> result;
+    result.reserve(pieces.size() + 1);
+
+    qint64 piece_pos = 0;
+    for (const auto &piece : pieces) {
+        const qint64 piece_end = piece_pos + piece.length;
+
+        if (piece_end <= pos || piece_pos >= end) {
+            result.push_back(piece);
+        } else {
+            if (piece_pos < pos) {
+                result.push_back(make_piece(piece.added, piece.start, pos - piece_pos));
+            }
+
+            if (piece_end > end) {
+                const qint64 skip = end - piece_pos;
+                result.push_back(make_piece(piece.added, piece.start + skip, piece.length - skip));
+            }
+        }
+
+        piece_pos = piece_end;
+    }
+
+    pieces.swap(result);
+
+    total_size -= len;
+    total_breaks = 0;
+    for (const auto &piece : pieces) {
+        total_breaks += piece.line_breaks;
+    }
+}
+
+bool PieceTable::write_to(QIODevice *device) const {
+    static constexpr qint64 CHUNK_SIZE = 1 << 20;
+
+    for (const auto &piece : pieces) {
+        const char *data = buffer(piece.added) + piece.start;
+
+        for (qint64 written = 0; written < piece.length; ) {
+            const qint64 ret = device->write(data + written, qMin(CHUNK_SIZE, piece.length - written));
+            if (ret <= 0) {
+                return false;
+            }
+
+            written += ret;
+        }
+    }
+
+    return true;
+}
+
+const char *PieceTable::buffer(bool added) const {
+    return added ? this->added.constData() : original;
+}
+
+qint64 PieceTable::count_breaks(bool added, qint64 start, qint64 length) const {
+    if (!added) {
+        return original_breaks_before(start + length) - original_breaks_before(start);
+    }
+
+    qint64 breaks = 0;
+    const char *cur = this->added.constData() + start;
+    const char *end = cur + length;
+    while ((cur = static_cast<const char*>(std::memchr(cur, '\n', end - cur))) != nullptr) {
+        ++breaks;
+        ++cur;
+    }
+
+    return breaks;
+}
+
+// number of newlines in original[0, offset)
+qint64 PieceTable::original_breaks_before(qint64 offset) const {
+    const auto it = std::upper_bound(original_index.begin(), original_index.end(), offset) - 1;
+    const qint64 checkpoint = it - original_index.begin();
+
+    qint64 breaks = checkpoint * LINE_INDEX_STEP;
+    const char *cur = original + *it;
+    const char *end = original + offset;
+    while ((cur = static_cast<const char*>(std::memchr(cur, '\n', end - cur))) != nullptr) {
+        ++breaks;
+        ++cur;
+    }
+
+    return breaks;
+}
+
+// offset right after the n-th (1-based) newline of the original buffer
+qint64 PieceTable::original_break_end(qint64 n) const {
+    const qint64 checkpoint = n / LINE_INDEX_STEP;
+    qint64 left = n - checkpoint * LINE_INDEX_STEP;
+
+    const char *cur = original + original_index[checkpoint];
+    const char *end = original + original_size;
+    while (left--) {
+        cur = static_cast<const char*>(std::memchr(cur, '\n', end - cur)) + 1;
+    }
+
+    return cur - original;
+}
+
+PieceTable::Piece PieceTable::make_piece(bool added, qint64 start, qint64 length) const {
+    return {added, start, length, count_breaks(added, start, length)};
+}
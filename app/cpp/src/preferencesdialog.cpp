@@ -4,6 +4,7 @@
 #include <QShortcut>
 #include <QFontDialog>
 #include <QMessageBox>
+#include <QTableWidgetItem>
 
 #include "ds/preferences.hpp"
 
@@ -18,6 +19,20 @@ PreferencesDialog::PreferencesDialog(Preferences *preferences, QDialog *parent)
     ui->compiler_path_input->setText(preferences->compiler_path);
     ui->compiler_args_input->setText(preferences->compiler_args);
 
+    for (const auto &profile : preferences->build_profiles) {
+        const int row = ui->profiles_table->rowCount();
+        ui->profiles_table->insertRow(row);
+        ui->profiles_table->setItem(row, 0, new QTableWidgetItem(profile.name));
+        ui->profiles_table->setItem(row, 1, new QTableWidgetItem(profile.compiler_args));
+    }
+
+    connect(ui->add_profile_button, &QPushButton::clicked, this, &PreferencesDialog::add_profile);
+    connect(ui->remove_profile_button, &QPushButton::clicked, this, &PreferencesDialog::remove_profile);
+
+    ui->large_file_input->setValue(preferences->large_file_size / (1024 * 1024));
+    ui->read_only_file_input->setValue(preferences->read_only_file_size / (1024 * 1024));
+    ui->tab_memory_input->setValue(preferences->tab_memory_budget / (1024 * 1024));
+
     ui->file_open_seq_edit->setKeySequence(preferences->shortcuts[ShortcutType::FILE_OPEN]);
     ui->file_save_seq_edit->setKeySequence(preferences->shortcuts[ShortcutType::FILE_SAVE]);
 
@@ -25,6 +40,8 @@ PreferencesDialog::PreferencesDialog(Preferences *preferences, QDialog *parent)
     
     ui->run_compile_seq_edit->setKeySequence(preferences->shortcuts[ShortcutType::RUN_COMPILE]);
     ui->run_exec_seq_edit->setKeySequence(preferences->shortcuts[ShortcutType::RUN_EXEC]);
+    ui->run_compile_exec_seq_edit->setKeySequence(preferences->shortcuts[ShortcutType::RUN_COMPILE_EXEC]);
+    ui->run_tests_seq_edit->setKeySequence(preferences->shortcuts[ShortcutType::RUN_TESTS]);
 
     ui->tab_close_seq_edit->setKeySequence(preferences->shortcuts[ShortcutType::TAB_CLOSE]);
     ui->tab_new_seq_edit->setKeySequence(preferences->shortcuts[ShortcutType::TAB_NEW]);
@@ -49,12 +66,53 @@ void PreferencesDialog::choose_editor_font() {
     }
 }
 
+void PreferencesDialog::add_profile() {
+    const int row = ui->profiles_table->rowCount();
+    ui->profiles_table->insertRow(row);
+    ui->profiles_table->setItem(row, 0, new QTableWidgetItem("Profile " + QString::number(row + 1)));
+    ui->profiles_table->setItem(row, 1, new QTableWidgetItem());
+    ui->profiles_table->editItem(ui->profiles_table->item(row, 0));
+}
+
+void PreferencesDialog::remove_profile() {
+    const int row = ui->profiles_table->currentRow();
+    if (row >= 0) {
+        ui->profiles_table->removeRow(row);
+    }
+}
+
 void PreferencesDialog::save() {
+    QVector<BuildProfile> build_profiles;
+    QStringList names;
+    for (int row = 0; row < ui->profiles_table->rowCount(); ++row) {
+        const QTableWidgetItem *name_item = ui->profiles_table->item(row, 0);
+        const QTableWidgetItem *args_item = ui->profiles_table->item(row, 1);
+
+        // files refer to their profile by name, so names have to be unique
+        const QString name = name_item != nullptr ? name_item->text().trimmed() : QString();
+        if (name.isEmpty() || names.contains(name)) {
+            continue;
+        }
+
+        names << name;
+        build_profiles.push_back({name, args_item != nullptr ? args_item->text().trimmed() : QString()});
+    }
+
+    if (build_profiles.isEmpty()) {
+        QMessageBox::warning(this, "Preferences saving", "At least one build profile is needed", QMessageBox::StandardButton::Ok);
+        return;
+    }
+
     preferences->compiler_path = ui->compiler_path_input->text();
     preferences->compiler_args = ui->compiler_args_input->text();
+    preferences->build_profiles = build_profiles;
     
     preferences->editor_font = buf_preferences.editor_font;
 
+    preferences->large_file_size     = qint64(ui->large_file_input->value()) * 1024 * 1024;
+    preferences->read_only_file_size = qint64(ui->read_only_file_input->value()) * 1024 * 1024;
+    preferences->tab_memory_budget   = qint64(ui->tab_memory_input->value()) * 1024 * 1024;
+
     qDebug() << ui->tab_new_seq_edit->keySequence().toString();
 
     preferences->shortcuts[ShortcutType::FILE_OPEN] = ui->file_open_seq_edit->keySequence();
@@ -64,6 +122,8 @@ void PreferencesDialog::save() {
     
     preferences->shortcuts[ShortcutType::RUN_COMPILE] = ui->run_compile_seq_edit->keySequence();
     preferences->shortcuts[ShortcutType::RUN_EXEC]    = ui->run_exec_seq_edit->keySequence();
+    preferences->shortcuts[ShortcutType::RUN_COMPILE_EXEC] = ui->run_compile_exec_seq_edit->keySequence();
+    preferences->shortcuts[ShortcutType::RUN_TESTS] = ui->run_tests_seq_edit->keySequence();
 
     preferences->shortcuts[ShortcutType::TAB_CLOSE] = ui->tab_close_seq_edit->keySequence();
     preferences->shortcuts[ShortcutType::TAB_NEW] =   ui->tab_new_seq_edit->keySequence();
@@ -0,0 +1,379 @@
+#include "processrun.hpp"
+#include "sampler.hpp"
+
+#include <QElapsedTimer>
+#include <QFile>
+#include <QVector>
+
+#include <cerrno>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include <algorithm>
+#include <vector>
+#include <mutex>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/ptrace.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+static void close_fd(int &fd) {
+    if (fd >= 0) {
+        ::close(fd);
+        fd = -1;
+    }
+}
+
+// reads what is available, false once the pipe is closed
+static bool drain(int &fd, QByteArray &buffer, qint64 limit, bool *truncated) {
+    char chunk[64 * 1024];
+
+    for (;;) {
+        const ssize_t ret = ::read(fd, chunk, sizeof(chunk));
+        if (ret > 0) {
+            const qint64 room = qMax<qint64>(0, limit - buffer.size());
+            buffer.append(chunk, qMin<qint64>(room, ret));
+            if (ret > room && truncated != nullptr) {
+                *truncated = true;
+            }
+            continue;
+        }
+
+        if (ret < 0 && errno == EINTR) {
+            continue;
+        }
+
+        if (ret < 0 && errno == EAGAIN) {
+            return true;
+        }
+
+        close_fd(fd);
+        return false;
+    }
+}
+
+static qint64 status_field_kb(const char *status, const char *field) {
+    const char *line = std::strstr(status, field);
+    return line != nullptr ? std::strtoll(line + std::strlen(field), nullptr, 10) : 0;
+}
+
+// VmHWM and VmPeak of a live process, in kilobytes
+static void read_peak_memory(pid_t pid, RunResult &result) {
+    char path[64];
+    std::snprintf(path, sizeof(path), "/proc/%d/status", int(pid));
+
+    const int fd = ::open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return;
+    }
+
+    char buffer[4096];
+    const ssize_t size = ::read(fd, buffer, sizeof(buffer) - 1);
+    ::close(fd);
+
+    if (size <= 0) {
+        return;
+    }
+    buffer[size] = '\0';
+
+    result.peak_memory_kb = status_field_kb(buffer, "VmHWM:");
+    result.peak_virtual_memory_kb = status_field_kb(buffer, "VmPeak:");
+}
+
+// limits can only be lowered, never raised past the inherited hard limit
+static void set_limit(int resource, rlim_t soft, rlim_t hard) {
+    struct rlimit limit;
+    if (::getrlimit(resource, &limit) != 0) {
+        return;
+    }
+
+    limit.rlim_max = std::min(limit.rlim_max, hard);
+    limit.rlim_cur = std::min(soft, limit.rlim_max);
+    ::setrlimit(resource, &limit);
+}
+
+RunResult ProcessRun::run(const QString &executable, const QStringList &arguments, const QByteArray &input,
+                          const QString &working_directory, const RunLimits &limits,
+                          Sampler *sampler) {
+    // a program exiting without reading its input must not take the IDE down
+    static std::once_flag ignore_sigpipe;
+    std::call_once(ignore_sigpipe, [] () {
+        ::signal(SIGPIPE, SIG_IGN);
+    });
+
+    RunResult result;
+
+    // everything the child touches is prepared before fork()
+    const QByteArray path = QFile::encodeName(executable);
+    const QByteArray directory = QFile::encodeName(working_directory);
+
+    QVector<QByteArray> encoded_arguments;
+    for (const auto &argument : arguments) {
+        encoded_arguments.push_back(argument.toLocal8Bit());
+    }
+
+    std::vector<char*> argv;
+    argv.push_back(const_cast<char*>(path.constData()));
+    for (const auto &argument : encoded_arguments) {
+        argv.push_back(const_cast<char*>(argument.constData()));
+    }
+    argv.push_back(nullptr);
+
+    // leak checking can't run under a tracer, a sanitized program would die at exit
+    static const char *const NO_LEAK_CHECK = "detect_leaks=0";
+
+    QVector<QByteArray> environment;
+    bool asan_options = false, lsan_options = false;
+    for (char **variable = environ; *variable != nullptr; ++variable) {
+        QByteArray entry(*variable);
+        if (entry.startsWith("ASAN_OPTIONS=") || entry.startsWith("LSAN_OPTIONS=")) {
+            (entry.startsWith("ASAN") ? asan_options : lsan_options) = true;
+            entry += QByteArray(":") + NO_LEAK_CHECK;
+        }
+        environment.push_back(entry);
+    }
+    if (!asan_options) {
+        environment.push_back(QByteArray("ASAN_OPTIONS=") + NO_LEAK_CHECK);
+    }
+    if (!lsan_options) {
+        environment.push_back(QByteArray("LSAN_OPTIONS=") + NO_LEAK_CHECK);
+    }
+
+    std::vector<char*> envp;
+    for (const auto &entry : environment) {
+        envp.push_back(const_cast<char*>(entry.constData()));
+    }
+    envp.push_back(nullptr);
+
+    // whole seconds, rounded up; the exact CPU time is checked against the limit afterwards
+    const rlim_t cpu_limit_s = limits.cpu_time_ms ? rlim_t((limits.cpu_time_ms + 999) / 1000 + 1) : 0;
+    const rlim_t memory_limit = limits.sanitized ? 0 : rlim_t(limits.memory_kb) * 1024;
+
+    int in_pipe[2], out_pipe[2], err_pipe[2], exec_pipe[2];
+    if (::pipe2(in_pipe, O_CLOEXEC) != 0) {
+        result.error = qt_error_string(errno);
+        return result;
+    }
+    if (::pipe2(out_pipe, O_CLOEXEC) != 0) {
+        result.error = qt_error_string(errno);
+        ::close(in_pipe[0]); ::close(in_pipe[1]);
+        return result;
+    }
+    if (::pipe2(err_pipe, O_CLOEXEC) != 0) {
+        result.error = qt_error_string(errno);
+        ::close(in_pipe[0]); ::close(in_pipe[1]);
+        ::close(out_pipe[0]); ::close(out_pipe[1]);
+        return result;
+    }
+    if (::pipe2(exec_pipe, O_CLOEXEC) != 0) {
+        result.error = qt_error_string(errno);
+        ::close(in_pipe[0]); ::close(in_pipe[1]);
+        ::close(out_pipe[0]); ::close(out_pipe[1]);
+        ::close(err_pipe[0]); ::close(err_pipe[1]);
+        return result;
+    }
+
+    QElapsedTimer wall_timer;
+    wall_timer.start();
+
+    const pid_t pid = ::fork();
+    if (pid == 0) {
+        // only async-signal-safe calls from here on
+        ::dup2(in_pipe[0], STDIN_FILENO);
+        ::dup2(out_pipe[1], STDOUT_FILENO);
+        ::dup2(err_pipe[1], STDERR_FILENO);
+        ::signal(SIGPIPE, SIG_DFL);
+
+        // lets the parent catch the exit while the address space is still alive;
+        // if ptrace is not allowed the program simply runs untraced
+        ::ptrace(PTRACE_TRACEME, 0, nullptr, nullptr);
+
+        // SIGXCPU at the soft limit, SIGKILL a second later if it's ignored
+        if (cpu_limit_s) {
+            set_limit(RLIMIT_CPU, cpu_limit_s, cpu_limit_s + 1);
+        }
+
+        // judges usually let the stack grow up to the memory limit
+        if (memory_limit) {
+            set_limit(RLIMIT_AS, memory_limit, memory_limit);
+            set_limit(RLIMIT_STACK, memory_limit, memory_limit);
+        }
+
+        set_limit(RLIMIT_CORE, 0, 0);
+
+        if (directory.isEmpty() || ::chdir(directory.constData()) == 0) {
+            ::execve(path.constData(), argv.data(), envp.data());
+        }
+
+        const int error = errno;
+        (void)!::write(exec_pipe[1], &error, sizeof(error));
+        ::_exit(127);
+    }
+
+    ::close(in_pipe[0]);
+    ::close(out_pipe[1]);
+    ::close(err_pipe[1]);
+    ::close(exec_pipe[1]);
+
+    if (pid < 0) {
+        result.error = qt_error_string(errno);
+        ::close(in_pipe[1]);
+        ::close(out_pipe[0]);
+        ::close(err_pipe[0]);
+        ::close(exec_pipe[0]);
+        return result;
+    }
+
+    int in_fd = in_pipe[1];
+    int out_fd = out_pipe[0];
+    int err_fd = err_pipe[0];
+
+    ::fcntl(in_fd, F_SETFL, O_NONBLOCK);
+    ::fcntl(out_fd, F_SETFL, O_NONBLOCK);
+    ::fcntl(err_fd, F_SETFL, O_NONBLOCK);
+
+    qint64 written = 0;
+    if (input.isEmpty()) {
+        close_fd(in_fd);
+    }
+
+    bool traced = false;
+    bool exited = false;
+    qint64 exited_at_ms = 0;
+    int status = 0;
+    struct rusage usage = {};
+
+    while (!exited || out_fd >= 0 || err_fd >= 0) {
+        if (out_fd < 0 && err_fd < 0 && in_fd < 0) {
+            ::poll(nullptr, 0, POLL_INTERVAL_MS);
+        } else {
+            pollfd fds[3];
+            nfds_t count = 0;
+
+            if (out_fd >= 0) fds[count++] = {out_fd, POLLIN, 0};
+            if (err_fd >= 0) fds[count++] = {err_fd, POLLIN, 0};
+            if (in_fd >= 0)  fds[count++] = {in_fd, POLLOUT, 0};
+
+            // the child's stops don't wake poll() up, so it's woken periodically
+            if (::poll(fds, count, POLL_INTERVAL_MS) < 0 && errno != EINTR) {
+                break;
+            }
+
+            for (nfds_t i = 0; i < count; ++i) {
+                if (!fds[i].revents) {
+                    continue;
+                }
+
+                if (fds[i].fd == out_fd) {
+                    drain(out_fd, result.output, MAX_OUTPUT, &result.output_truncated);
+                } else if (fds[i].fd == err_fd) {
+                    drain(err_fd, result.error_output, MAX_ERROR_OUTPUT, nullptr);
+                } else if (fds[i].fd == in_fd) {
+                    const ssize_t ret = ::write(in_fd, input.constData() + written, input.size() - written);
+                    if (ret > 0) {
+                        written += ret;
+                    }
+
+                    // EPIPE: the program stopped reading, which is its business
+                    if ((ret < 0 && errno != EAGAIN && errno != EINTR) || written == input.size()) {
+                        close_fd(in_fd);
+                    }
+                }
+            }
+        }
+
+        if (exited) {
+            // a background process the program left behind may hold the pipes open forever
+            if (wall_timer.elapsed() - exited_at_ms > DRAIN_AFTER_EXIT_MS) {
+                close_fd(out_fd);
+                close_fd(err_fd);
+            }
+            continue;
+        }
+
+        if (sampler != nullptr) {
+            sampler->collect();
+        }
+
+        if (limits.wall_time_ms && !result.wall_time_exceeded && wall_timer.elapsed() > limits.wall_time_ms) {
+            result.wall_time_exceeded = true;
+            ::kill(pid, SIGKILL);
+        }
+
+        const pid_t ret = ::wait4(pid, &status, WNOHANG | __WALL, &usage);
+        if (ret < 0 && errno != EINTR) {
+            break;
+        }
+        if (ret != pid) {
+            continue;
+        }
+
+        if (!WIFSTOPPED(status)) {
+            exited = true;
+            result.wall_time_ms = wall_timer.elapsed();
+            exited_at_ms = result.wall_time_ms;
+            close_fd(in_fd);
+            continue;
+        }
+
+        if (!traced) {
+            // stopped right after exec, the program hasn't run a single instruction yet
+            traced = true;
+            ::ptrace(PTRACE_SETOPTIONS, pid, nullptr, PTRACE_O_TRACEEXIT | PTRACE_O_EXITKILL);
+
+            // a failed attach leaves the error in the sampler, the run itself goes on
+            if (sampler != nullptr) {
+                sampler->attach(pid);
+            }
+
+            ::ptrace(PTRACE_CONT, pid, nullptr, nullptr);
+        } else if (status >> 8 == (SIGTRAP | (PTRACE_EVENT_EXIT << 8))) {
+            // the address space is still there, so its high-water mark can be read
+            read_peak_memory(pid, result);
+            ::ptrace(PTRACE_CONT, pid, nullptr, nullptr);
+        } else {
+            // deliver whatever signal stopped it
+            ::ptrace(PTRACE_CONT, pid, nullptr, reinterpret_cast<void*>(static_cast<quintptr>(WSTOPSIG(status))));
+        }
+    }
+
+    result.traced = traced;
+    close_fd(in_fd);
+    close_fd(out_fd);
+    close_fd(err_fd);
+
+    // the buffer outlives the program, whatever it wrote last is still there
+    if (sampler != nullptr) {
+        sampler->collect();
+        sampler->detach();
+    }
+
+    int exec_error = 0;
+    const bool exec_failed = ::read(exec_pipe[0], &exec_error, sizeof(exec_error)) == sizeof(exec_error);
+    ::close(exec_pipe[0]);
+
+    if (exec_failed) {
+        result.error = qt_error_string(exec_error);
+        return result;
+    }
+
+    result.started = true;
+
+    if (WIFSIGNALED(status)) {
+        result.signaled = true;
+        result.signal = WTERMSIG(status);
+    } else {
+        result.exit_code = WEXITSTATUS(status);
+    }
+
+    result.user_time_ms = usage.ru_utime.tv_sec * 1000 + usage.ru_utime.tv_usec / 1000;
+    result.system_time_ms = usage.ru_stime.tv_sec * 1000 + usage.ru_stime.tv_usec / 1000;
+    result.cpu_time_ms = result.user_time_ms + result.system_time_ms;
+
+    return result;
+}
@@ -0,0 +1,136 @@
+#include "profiler.hpp"
+
+#include <QFile>
+#include <QFileInfo>
+#include <QProcess>
+#include <QRegularExpression>
+#include <QStandardPaths>
+
+#include "processrun.hpp"
+#include "sampler.hpp"
+#include "testrunner.hpp"
+
+Profiler::Profiler(QObject *parent)
+    : QObject(parent)
+{
+    pool.setMaxThreadCount(1);
+}
+
+Profiler::~Profiler() {
+    pool.clear();
+    pool.waitForDone();
+}
+
+void Profiler::run(const QString &executable, const QString &source_file, const TestCase &test, const RunLimits &limits) {
+    const quint64 run_generation = ++generation;
+    pool.clear();
+
+    RunLimits run_limits;
+    run_limits.wall_time_ms = TestRunner::process_limits(limits).wall_time_ms;
+
+    pool.start([this, run_generation, executable, source_file, test, run_limits] () {
+        QFile input(test.input_file);
+
+        ProfileResult result;
+        result.test_name = test.name;
+
+        Sampler sampler;
+        result.run = ProcessRun::run(executable, {}, input.open(QIODevice::ReadOnly) ? input.readAll() : QByteArray(),
+                                     QFileInfo(executable).absolutePath(), run_limits, &sampler);
+
+        result.total_samples = sampler.total();
+        result.outside_samples = sampler.outside();
+        result.lost_samples = sampler.lost();
+
+        if (!result.run.started) {
+            result.error = result.run.error;
+        } else if (!result.run.traced) {
+            result.error = "The program couldn't be traced, ptrace was refused"
+                           " (see /proc/sys/kernel/yama/ptrace_scope)";
+        } else if (!sampler.error().isEmpty()) {
+            result.error = sampler.error();
+        } else if (sampler.total() == 0) {
+            result.error = "No samples were taken, the program ran too briefly";
+        } else {
+            map_lines(executable, source_file, sampler.samples(), result);
+        }
+
+        QMetaObject::invokeMethod(this, [this, run_generation, result] () {
+            if (run_generation == generation) {
+                emit finished(result);
+            }
+        });
+    });
+}
+
+void Profiler::map_lines(const QString &executable, const QString &source_file,
+                         const QHash<quint64, quint64> &samples, ProfileResult &result) {
+    const QString addr2line = QStandardPaths::findExecutable("addr2line");
+    if (addr2line.isEmpty()) {
+        result.error = "addr2line was not found, it comes with binutils";
+        return;
+    }
+
+    QByteArray addresses;
+    for (auto it = samples.cbegin(); it != samples.cend(); ++it) {
+        addresses += "0x" + QByteArray::number(it.key(), 16) + '\n';
+    }
+
+    // -a marks where each address starts, -i lists the chain of inlined calls innermost first
+    QProcess process;
+    process.start(addr2line, {"-a", "-i", "-e", executable});
+    process.write(addresses);
+    process.closeWriteChannel();
+
+    if (!process.waitForFinished(ADDR2LINE_TIMEOUT_MS) || process.exitCode() != 0) {
+        result.error = "addr2line failed: " + QString::fromLocal8Bit(process.readAllStandardError()).trimmed();
+        process.kill();
+        return;
+    }
+
+    const QString source_path = QFileInfo(source_file).canonicalFilePath();
+
+    // debug info usually repeats the same few file names
+    QHash<QString, bool> is_source;
+    auto in_source = [&is_source, &source_path] (const QString &file) {
+        auto it = is_source.constFind(file);
+        if (it == is_source.cend()) {
+            it = is_source.insert(file, QFileInfo(file).canonicalFilePath() == source_path);
+        }
+        return it.value();
+    };
+
+    static const QRegularExpression discriminator_re(" \\(discriminator \\d+\\)$");
+
+    quint64 samples_at_address = 0;
+    bool address_mapped = true;
+
+    for (const QByteArray &raw_line : process.readAllStandardOutput().split('\n')) {
+        if (raw_line.startsWith("0x")) {
+            samples_at_address = samples.value(raw_line.mid(2).toULongLong(nullptr, 16));
+            address_mapped = false;
+            continue;
+        }
+
+        if (address_mapped || raw_line.isEmpty()) {
+            continue;
+        }
+
+        QString location = QString::fromLocal8Bit(raw_line);
+        location.remove(discriminator_re);
+
+        const qsizetype colon = location.lastIndexOf(':');
+        if (colon <= 0) {
+            continue;
+        }
+
+        const int line = location.mid(colon + 1).toInt();
+        if (line <= 0 || !in_source(location.left(colon))) {
+            continue;
+        }
+
+        result.line_samples[line] += samples_at_address;
+        result.source_samples += samples_at_address;
+        address_mapped = true;
+    }
+}
@@ -0,0 +1,188 @@
+#include "sampler.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+
+#include <elf.h>
+#include <fcntl.h>
+#include <linux/perf_event.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+Sampler::~Sampler() {
+    detach();
+}
+
+bool Sampler::attach(pid_t pid) {
+    detach();
+
+    if (!find_image(pid)) {
+        last_error = "Can't find the program's mapping";
+        return false;
+    }
+
+    struct perf_event_attr attr;
+    std::memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_SOFTWARE;
+    attr.config = PERF_COUNT_SW_TASK_CLOCK;
+    attr.sample_period = SAMPLE_PERIOD_NS;
+    attr.sample_type = PERF_SAMPLE_IP;
+    // the program's own code is all that can be mapped to source lines
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+
+    fd = int(::syscall(SYS_perf_event_open, &attr, pid, -1, -1, PERF_FLAG_FD_CLOEXEC));
+    if (fd < 0) {
+        last_error = "perf_event_open failed: " + QString::fromLocal8Bit(std::strerror(errno))
+                   + ", check /proc/sys/kernel/perf_event_paranoid";
+        return false;
+    }
+
+    const size_t page_size = size_t(::sysconf(_SC_PAGESIZE));
+    buffer_size = (DATA_PAGES + 1) * page_size;
+    buffer = ::mmap(nullptr, buffer_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+
+    if (buffer == MAP_FAILED) {
+        last_error = "Can't map the sample buffer: " + QString::fromLocal8Bit(std::strerror(errno));
+        buffer = nullptr;
+        detach();
+        return false;
+    }
+
+    return true;
+}
+
+void Sampler::collect() {
+    if (buffer == nullptr) {
+        return;
+    }
+
+    auto *header = static_cast<perf_event_mmap_page*>(buffer);
+    const char *data = static_cast<const char*>(buffer) + header->data_offset;
+    const quint64 data_size = header->data_size;
+
+    const quint64 head = __atomic_load_n(&header->data_head, __ATOMIC_ACQUIRE);
+    quint64 tail = header->data_tail;
+
+    // records may wrap around the end of the buffer
+    auto read = [data, data_size] (quint64 offset, void *out, size_t size) {
+        for (size_t i = 0; i < size; ++i) {
+            static_cast<char*>(out)[i] = data[(offset + i) % data_size];
+        }
+    };
+
+    while (tail + sizeof(perf_event_header) <= head) {
+        perf_event_header record;
+        read(tail, &record, sizeof(record));
+
+        if (record.size == 0 || tail + record.size > head) {
+            break;
+        }
+
+        if (record.type == PERF_RECORD_SAMPLE) {
+            quint64 ip = 0;
+            read(tail + sizeof(record), &ip, sizeof(ip));
+            add_sample(ip);
+        } else if (record.type == PERF_RECORD_LOST) {
+            quint64 lost[2] = {}; // id, count
+            read(tail + sizeof(record), lost, sizeof(lost));
+            lost_samples += lost[1];
+        }
+
+        tail += record.size;
+    }
+
+    __atomic_store_n(&header->data_tail, tail, __ATOMIC_RELEASE);
+}
+
+void Sampler::detach() {
+    if (buffer != nullptr) {
+        ::munmap(buffer, buffer_size);
+        buffer = nullptr;
+    }
+
+    if (fd >= 0) {
+        ::close(fd);
+        fd = -1;
+    }
+}
+
+bool Sampler::find_image(pid_t pid) {
+    char path[64];
+
+    // the path in the maps is the one the exe link resolves to
+    std::snprintf(path, sizeof(path), "/proc/%d/exe", int(pid));
+    char executable[4096];
+    const ssize_t length = ::readlink(path, executable, sizeof(executable) - 1);
+    if (length <= 0) {
+        return false;
+    }
+    executable[length] = '\0';
+
+    // position independent executables are loaded at a random base
+    Elf64_Ehdr elf_header;
+    const int exe_fd = ::open(path, O_RDONLY | O_CLOEXEC);
+    if (exe_fd < 0) {
+        return false;
+    }
+    const bool header_read = ::read(exe_fd, &elf_header, sizeof(elf_header)) == sizeof(elf_header);
+    ::close(exe_fd);
+
+    if (!header_read || std::memcmp(elf_header.e_ident, ELFMAG, SELFMAG) != 0) {
+        return false;
+    }
+    const bool relocated = elf_header.e_type == ET_DYN;
+
+    std::snprintf(path, sizeof(path), "/proc/%d/maps", int(pid));
+    FILE *maps = std::fopen(path, "re");
+    if (maps == nullptr) {
+        return false;
+    }
+
+    image_begin = 0;
+    image_end = 0;
+    image_bias = 0;
+
+    char line[4096 + 256];
+    while (std::fgets(line, sizeof(line), maps) != nullptr) {
+        unsigned long long begin, end, offset;
+        int name_start = 0;
+        if (std::sscanf(line, "%llx-%llx %*s %llx %*s %*s %n", &begin, &end, &offset, &name_start) < 3 || name_start == 0) {
+            continue;
+        }
+
+        char *name = line + name_start;
+        name[std::strcspn(name, "\n")] = '\0';
+        if (std::strcmp(name, executable) != 0) {
+            continue;
+        }
+
+        if (image_end == 0 || begin < image_begin) {
+            image_begin = begin;
+        }
+        image_end = std::max<quint64>(image_end, end);
+
+        if (relocated && offset == 0) {
+            image_bias = begin;
+        }
+    }
+
+    std::fclose(maps);
+
+    return image_end != 0;
+}
+
+void Sampler::add_sample(quint64 ip) {
+    ++total_samples;
+
+    if (ip < image_begin || ip >= image_end) {
+        ++outside_samples;
+        return;
+    }
+
+    ++image_samples[ip - image_bias];
+}
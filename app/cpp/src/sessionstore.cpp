@@ -0,0 +1,111 @@
+#include "sessionstore.hpp"
+
+#include <QDataStream>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QStandardPaths>
+
+static void write_tab(QDataStream &stream, const SessionTab &tab) {
+    stream << tab.name << tab.file_name.has_value() << tab.file_name.value_or(QString())
+           << tab.cursor_position << tab.scroll_position << tab.folded_blocks
+           << tab.modified << tab.buffer;
+
+    stream << tab.journal_id; // version 2
+}
+
+static void read_tab(QDataStream &stream, quint16 version, SessionTab &tab) {
+    bool has_file_name;
+    QString file_name;
+
+    stream >> tab.name >> has_file_name >> file_name
+           >> tab.cursor_position >> tab.scroll_position >> tab.folded_blocks
+           >> tab.modified >> tab.buffer;
+
+    if (version >= 2) {
+        stream >> tab.journal_id;
+    }
+
+    if (has_file_name) {
+        tab.file_name = file_name;
+    }
+}
+
+QString SessionStore::default_path() {
+    return QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + "/session.bin";
+}
+
+std::optional<Session> SessionStore::read(const QString &file_name) {
+    QFile file(file_name);
+    if (!file.open(QIODevice::ReadOnly) || file.size() == 0) {
+        return std::nullopt;
+    }
+
+    uchar *data = file.map(0, file.size());
+    if (data == nullptr) {
+        return std::nullopt;
+    }
+
+    // everything read from the stream is deep-copied, so the mapping can go away afterwards
+    const QByteArray bytes = QByteArray::fromRawData(reinterpret_cast<const char*>(data), file.size());
+    QDataStream stream(bytes);
+    stream.setVersion(QDataStream::Qt_6_0);
+
+    quint32 magic;
+    quint16 version;
+    stream >> magic >> version;
+
+    if (magic != MAGIC || version > VERSION) {
+        file.unmap(data);
+        return std::nullopt;
+    }
+
+    Session session;
+    stream >> session.current_tab;
+
+    quint32 tabs_amount;
+    stream >> tabs_amount;
+
+    for (quint32 i = 0; i < tabs_amount && stream.status() == QDataStream::Ok; ++i) {
+        SessionTab tab;
+        read_tab(stream, version, tab);
+        session.tabs.push_back(tab);
+    }
+
+    const bool ok = stream.status() == QDataStream::Ok;
+    file.unmap(data);
+
+    if (!ok) {
+        return std::nullopt;
+    }
+
+    return session;
+}
+
+bool SessionStore::write(const QString &file_name, const Session &session) {
+    QDir().mkpath(QFileInfo(file_name).absolutePath());
+
+    QSaveFile file(file_name);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_6_0);
+
+    stream << MAGIC << VERSION;
+    stream << session.current_tab;
+    stream << quint32(session.tabs.size());
+
+    for (const auto &tab : session.tabs) {
+        write_tab(stream, tab);
+    }
+
+    if (stream.status() != QDataStream::Ok) {
+        file.cancelWriting();
+        return false;
+    }
+
+    return file.commit();
+}
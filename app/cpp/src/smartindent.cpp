@@ -0,0 +1,128 @@
+#include "smartindent.hpp"
+
+#include <QRegularExpression>
+#include <QTextBlock>
+
+QString SmartIndent::indent_after(const QTextBlock &block) {
+    const QString text = block.text();
+    const QString base = leading_whitespace(text);
+    const QString block_code = code(text);
+
+    if (block_code.isEmpty()) {
+        return base;
+    }
+
+    // a braceless body is always one level deeper, however deep the nesting
+    if (opens_scope(block_code) || is_label(block_code) || is_control_header(block_code)) {
+        return base + UNIT;
+    }
+
+    QTextBlock prev = block.previous();
+
+    if (is_operator_continuation(block_code)) {
+        // a chain of continuation lines is only indented once
+        if (prev.isValid() && is_operator_continuation(code(prev.text()))) {
+            return base;
+        }
+
+        return base + UNIT;
+    }
+
+    // the statement ends here: go back to where its continuation chain started
+    QString indent = base;
+    for (int i = 0; i < MAX_CHAIN && prev.isValid(); ++i, prev = prev.previous()) {
+        const QString prev_code = code(prev.text());
+        if (!is_continuation(prev_code)) {
+            break;
+        }
+
+        indent = leading_whitespace(prev.text());
+    }
+
+    return indent;
+}
+
+QString SmartIndent::leading_whitespace(const QString &text) {
+    qsizetype i = 0;
+    while (i < text.size() && (text[i] == ' ' || text[i] == '\t')) {
+        ++i;
+    }
+
+    return text.left(i);
+}
+
+QString SmartIndent::dedent(const QString &indent) {
+    if (indent.endsWith(UNIT)) {
+        return indent.chopped(1);
+    }
+
+    qsizetype spaces = 0;
+    while (spaces < TAB_STOP && spaces < indent.size() && indent[indent.size() - 1 - spaces] == ' ') {
+        ++spaces;
+    }
+
+    return indent.chopped(spaces);
+}
+
+QString SmartIndent::code(const QString &text) {
+    // "//" inside a string or character literal doesn't start a comment
+    QChar quote;
+    qsizetype comment = -1;
+
+    for (qsizetype i = 0; i < text.size() && comment == -1; ++i) {
+        const QChar c = text[i];
+
+        if (!quote.isNull()) {
+            if (c == '\\') {
+                ++i;
+            } else if (c == quote) {
+                quote = QChar();
+            }
+        } else if (c == '"' || c == '\'') {
+            quote = c;
+        } else if (c == '/' && i + 1 < text.size() && text[i + 1] == '/') {
+            comment = i;
+        }
+    }
+
+    return (comment == -1 ? text : text.left(comment)).trimmed();
+}
+
+bool SmartIndent::opens_scope(const QString &code) {
+    const QChar last = code.back();
+
+    return last == '{' || last == '(' || last == '[';
+}
+
+bool SmartIndent::is_label(const QString &code) {
+    static const QRegularExpression label_regexp(
+        "^(case\\b.*|default\\s*|public|protected|private|signals|(public|protected|private)\\s+slots)\\s*:$"
+    );
+
+    return label_regexp.match(code).hasMatch();
+}
+
+bool SmartIndent::is_control_header(const QString &code) {
+    static const QRegularExpression control_regexp(
+        "^(\\}\\s*)?((else\\s+)?if|for|while)\\s*\\(.*\\)$|^(\\}\\s*)?(else|do)$"
+    );
+
+    return control_regexp.match(code).hasMatch();
+}
+
+bool SmartIndent::is_operator_continuation(const QString &code) {
+    // a trailing "*/" closes a comment, it is not a multiplication or division
+    static const QRegularExpression operator_regexp(
+        "([=?:%|&^<]|(^|[^/])\\*|(^|[^*])/|(^|[^+])\\+|(^|[^-])-|>>)$"
+    );
+
+    if (code.isEmpty() || code.endsWith(',') || is_label(code)) {
+        return false;
+    }
+
+    return operator_regexp.match(code).hasMatch();
+}
+
+bool SmartIndent::is_continuation(const QString &code) {
+    return is_control_header(code) || is_operator_continuation(code);
+}
@@ -0,0 +1,70 @@
+#include "stressdialog.hpp"
+#include "ui_stressdialog.h"
+
+#include <QFileDialog>
+#include <QFileInfo>
+#include <QMessageBox>
+
+StressDialog::StressDialog(QWidget *parent)
+    : QDialog(parent), ui(new Ui::StressDialog)
+{
+    ui->setupUi(this);
+
+    connect(ui->solution_browse_button, &QToolButton::clicked, this, [this] () {
+        browse(ui->solution_input);
+    });
+    connect(ui->brute_browse_button, &QToolButton::clicked, this, [this] () {
+        browse(ui->brute_input);
+    });
+    connect(ui->generator_browse_button, &QToolButton::clicked, this, [this] () {
+        browse(ui->generator_input);
+    });
+}
+
+StressDialog::~StressDialog() {
+    delete ui;
+}
+
+void StressDialog::set_sources(const QString &solution, const QString &brute, const QString &generator) {
+    ui->solution_input->setText(solution);
+    ui->brute_input->setText(brute);
+    ui->generator_input->setText(generator);
+}
+
+void StressDialog::set_cases(int cases) {
+    ui->cases_input->setValue(cases);
+}
+
+QString StressDialog::solution() const {
+    return ui->solution_input->text();
+}
+
+QString StressDialog::brute() const {
+    return ui->brute_input->text();
+}
+
+QString StressDialog::generator() const {
+    return ui->generator_input->text();
+}
+
+int StressDialog::cases() const {
+    return ui->cases_input->value();
+}
+
+void StressDialog::accept() {
+    for (const QString &source : {solution(), brute(), generator()}) {
+        if (!QFileInfo(source).isFile()) {
+            QMessageBox::warning(this, "Stress Test", "\"" + source + "\" is not a file");
+            return;
+        }
+    }
+
+    QDialog::accept();
+}
+
+void StressDialog::browse(QLineEdit *input) {
+    const QString file_name = QFileDialog::getOpenFileName(this, "Choose source", QFileInfo(input->text()).absolutePath());
+    if (!file_name.isEmpty()) {
+        input->setText(file_name);
+    }
+}
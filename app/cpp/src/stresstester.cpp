@@ -0,0 +1,138 @@
+#include "stresstester.hpp"
+
+#include <QThread>
+
+#include "processrun.hpp"
+#include "testrunner.hpp"
+
+StressTester::StressTester(QObject *parent)
+    : QObject(parent)
+{
+}
+
+StressTester::~StressTester() {
+    cancel();
+    pool.waitForDone();
+}
+
+void StressTester::start(const QString &generator, const QString &brute, const QString &solution,
+                         const QString &working_directory, quint64 cases, const RunLimits &solution_limits) {
+    cancel();
+
+    state = std::make_shared<State>();
+
+    const int workers = qMax(1, pool.maxThreadCount());
+    state->workers = workers;
+
+    for (int i = 0; i < workers; ++i) {
+        pool.start([this, run_state = state, generator, brute, solution, working_directory, cases, solution_limits] () {
+            run_worker(run_state, generator, brute, solution, working_directory, cases, solution_limits);
+        });
+    }
+}
+
+void StressTester::cancel() {
+    if (state != nullptr) {
+        state->stop = true;
+        state.reset();
+    }
+}
+
+static QString failure_details(const RunResult &run) {
+    if (!run.started) {
+        return run.error;
+    }
+
+    if (run.wall_time_exceeded) {
+        return "timed out";
+    }
+
+    const QString details = run.signaled ? "killed by signal " + QString::number(run.signal)
+                                         : "exit code " + QString::number(run.exit_code);
+
+    const QString error_output = QString::fromUtf8(run.error_output).trimmed();
+    return error_output.isEmpty() ? details : details + ", " + error_output;
+}
+
+static bool run_failed(const RunResult &run) {
+    return !run.started || run.signaled || run.exit_code != 0 || run.wall_time_exceeded;
+}
+
+// runs on a pool thread
+void StressTester::run_worker(std::shared_ptr<State> run_state, QString generator, QString brute, QString solution,
+                              QString working_directory, quint64 cases, RunLimits solution_limits) {
+    const RunLimits helper_limits = TestRunner::process_limits({});
+    const RunLimits run_limits = TestRunner::process_limits(solution_limits);
+
+    const auto report = [this, run_state] (StressFailure failure) {
+        // only the first failure of the session is reported
+        if (run_state->stop.exchange(true)) {
+            return;
+        }
+        run_state->failed = true;
+
+        QMetaObject::invokeMethod(this, [this, run_state, failure] () {
+            if (state == run_state) {
+                emit failed(failure);
+            }
+        });
+    };
+
+    while (!run_state->stop) {
+        const quint64 seed = run_state->next_case++;
+        if (seed > cases) {
+            break;
+        }
+
+        StressFailure failure;
+        failure.seed = seed;
+
+        const RunResult input = ProcessRun::run(generator, {QString::number(seed)}, {}, working_directory, helper_limits);
+        if (run_failed(input)) {
+            failure.message = "generator failed: " + failure_details(input);
+            report(failure);
+            break;
+        }
+        failure.input = input.output;
+
+        const RunResult expected = ProcessRun::run(brute, {}, failure.input, working_directory, helper_limits);
+        if (run_failed(expected)) {
+            failure.message = "brute force failed: " + failure_details(expected);
+            report(failure);
+            break;
+        }
+        failure.expected = expected.output;
+
+        const RunResult output = ProcessRun::run(solution, {}, failure.input, working_directory, run_limits);
+        const TestResult result = TestRunner::judge(0, output, failure.expected, solution_limits);
+        if (result.verdict != Verdict::ACCEPTED) {
+            failure.verdict = result.verdict;
+            failure.output = output.output;
+            failure.message = result.message;
+            report(failure);
+            break;
+        }
+
+        const quint64 done = ++run_state->cases_done;
+        if (done % PROGRESS_INTERVAL == 0) {
+            QMetaObject::invokeMethod(this, [this, run_state, done] () {
+                if (state == run_state) {
+                    emit progress(done);
+                }
+            });
+        }
+    }
+
+    QMetaObject::invokeMethod(this, [this, run_state] () {
+        worker_finished(run_state);
+    });
+}
+
+void StressTester::worker_finished(const std::shared_ptr<State> &run_state) {
+    if (--run_state->workers > 0 || state != run_state) {
+        return;
+    }
+
+    state.reset();
+    emit finished(run_state->cases_done, run_state->failed);
+}
@@ -0,0 +1,91 @@
+#include "tabregistry.hpp"
+
+#include <QFile>
+#include <QFileInfo>
+
+#include <sys/stat.h>
+
+QString TabRegistry::canonical_path(const QString &file_name) {
+    const QFileInfo info(file_name);
+    const QString canonical = info.canonicalFilePath();
+
+    // canonicalFilePath() is empty for files that don't exist
+    return canonical.isEmpty() ? info.absoluteFilePath() : canonical;
+}
+
+void TabRegistry::add(CodeEditor *editor, const QString &file_name) {
+    remove(editor);
+
+    Entry entry;
+    entry.path = canonical_path(file_name);
+    entry.key = file_key(entry.path);
+
+    entries.insert(editor, entry);
+    by_path.insert(entry.path, editor);
+    if (entry.key.inode) {
+        by_inode.insert(entry.key, editor);
+    }
+}
+
+void TabRegistry::remove(CodeEditor *editor) {
+    const auto it = entries.constFind(editor);
+    if (it == entries.cend()) {
+        return;
+    }
+
+    // another tab may have taken over the path or a recycled inode since
+    if (by_path.value(it->path) == editor) {
+        by_path.remove(it->path);
+    }
+    if (it->key.inode && by_inode.value(it->key) == editor) {
+        by_inode.remove(it->key);
+    }
+
+    entries.erase(it);
+}
+
+void TabRegistry::refresh(CodeEditor *editor) {
+    const auto it = entries.constFind(editor);
+    if (it == entries.cend()) {
+        return;
+    }
+
+    const FileKey key = file_key(it->path);
+    if (key == it->key) {
+        return;
+    }
+
+    add(editor, it->path);
+}
+
+CodeEditor *TabRegistry::find(const QString &file_name) const {
+    const QString path = canonical_path(file_name);
+
+    const FileKey key = file_key(path);
+    if (key.inode) {
+        CodeEditor *editor = by_inode.value(key);
+        // the key is stale if the tab's file was replaced and its inode reused
+        if (editor != nullptr && file_key(entries.value(editor).path) == key) {
+            return editor;
+        }
+    }
+
+    return by_path.value(path);
+}
+
+QStringList TabRegistry::paths() const {
+    return by_path.keys();
+}
+
+QList<CodeEditor*> TabRegistry::editors() const {
+    return entries.keys();
+}
+
+TabRegistry::FileKey TabRegistry::file_key(const QString &path) {
+    struct stat st;
+    if (::stat(QFile::encodeName(path).constData(), &st) != 0) {
+        return {};
+    }
+
+    return {quint64(st.st_dev), quint64(st.st_ino)};
+}
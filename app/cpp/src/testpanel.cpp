@@ -0,0 +1,81 @@
+#include "testpanel.hpp"
+
+#include <QBrush>
+#include <QHeaderView>
+
+TestPanel::TestPanel(QWidget *parent)
+    : QTreeWidget(parent)
+{
+    setRootIsDecorated(false);
+    setUniformRowHeights(true);
+    setHeaderLabels({"Test", "Verdict", "Time", "CPU", "Memory", "Details"});
+    header()->setStretchLastSection(true);
+
+    connect(this, &QTreeWidget::itemDoubleClicked, this, [this] (QTreeWidgetItem *item) {
+        if (item->data(VERDICT, Qt::UserRole).toBool()) {
+            emit diff_requested(indexOfTopLevelItem(item));
+        }
+    });
+}
+
+void TestPanel::reset(const QStringList &test_names) {
+    clear();
+    passed = 0;
+
+    for (const auto &name : test_names) {
+        QTreeWidgetItem *item = new QTreeWidgetItem(this);
+        item->setText(NAME, name);
+        item->setText(VERDICT, "Running");
+    }
+}
+
+void TestPanel::set_result(const TestResult &result) {
+    QTreeWidgetItem *item = topLevelItem(result.index);
+    if (item == nullptr) {
+        return;
+    }
+
+    if (result.verdict == Verdict::ACCEPTED) {
+        ++passed;
+    }
+
+    item->setText(VERDICT, verdict_name(result.verdict));
+    item->setForeground(VERDICT, QBrush(result.verdict == Verdict::ACCEPTED ? Qt::darkGreen : Qt::red));
+
+    if (result.run.started) {
+        item->setText(TIME, QString::number(result.run.wall_time_ms) + " ms");
+        item->setText(CPU, QString::number(result.run.cpu_time_ms) + " ms");
+        item->setToolTip(CPU, "user " + QString::number(result.run.user_time_ms) + " ms, sys "
+                              + QString::number(result.run.system_time_ms) + " ms");
+        item->setText(MEMORY, result.run.peak_memory_kb ? QString::number(result.run.peak_memory_kb / 1024.0, 'f', 1) + " MB" : "?");
+    }
+
+    // there is an output to compare once the program ran
+    item->setData(VERDICT, Qt::UserRole, result.run.started);
+
+    item->setText(DETAILS, result.message);
+    item->setToolTip(DETAILS, result.message);
+}
+
+QString TestPanel::summary() const {
+    return QString::number(passed) + '/' + QString::number(topLevelItemCount()) + " passed";
+}
+
+QString TestPanel::verdict_name(Verdict verdict) {
+    switch (verdict) {
+        case Verdict::ACCEPTED:
+            return "OK";
+        case Verdict::WRONG_ANSWER:
+            return "WA";
+        case Verdict::RUNTIME_ERROR:
+            return "RE";
+        case Verdict::TIME_LIMIT:
+            return "TL";
+        case Verdict::MEMORY_LIMIT:
+            return "ML";
+        case Verdict::FAILED:
+            return "Failed";
+    }
+
+    return "";
+}
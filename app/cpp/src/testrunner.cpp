@@ -0,0 +1,133 @@
+#include "testrunner.hpp"
+
+#include <QFile>
+#include <QRegularExpression>
+#include <QSaveFile>
+
+#include "checker.hpp"
+#include "processrun.hpp"
+
+TestRunner::TestRunner(QObject *parent)
+    : QObject(parent)
+{
+}
+
+TestRunner::~TestRunner() {
+    pool.clear();
+    pool.waitForDone();
+}
+
+static QByteArray read_file(const QString &file_name) {
+    QFile file(file_name);
+    return file.open(QIODevice::ReadOnly) ? file.readAll() : QByteArray();
+}
+
+void TestRunner::run(const QString &executable, const QString &working_directory,
+                     const QVector<TestCase> &tests, const RunLimits &limits) {
+    cancel();
+
+    const quint64 run_generation = generation;
+    const RunLimits run_limits = process_limits(limits);
+    remaining = tests.size();
+
+    for (int i = 0; i < tests.size(); ++i) {
+        const TestCase test = tests[i];
+
+        pool.start([this, run_generation, i, executable, working_directory, test, limits, run_limits] () {
+            RunResult run = ProcessRun::run(executable, {}, read_file(test.input_file), working_directory, run_limits);
+
+            QSaveFile output(test.output_file);
+            if (output.open(QIODevice::WriteOnly)) {
+                output.write(run.output);
+                output.commit();
+            }
+
+            const TestResult result = judge(i, run, read_file(test.expected_file), limits);
+
+            QMetaObject::invokeMethod(this, [this, run_generation, result] () {
+                if (run_generation != generation) {
+                    return;
+                }
+
+                emit test_finished(result);
+
+                if (--remaining == 0) {
+                    emit finished();
+                }
+            });
+        });
+    }
+
+    if (tests.isEmpty()) {
+        emit finished();
+    }
+}
+
+void TestRunner::cancel() {
+    ++generation;
+    remaining = 0;
+    pool.clear();
+}
+
+RunLimits TestRunner::problem_limits(const Problem &problem) {
+    RunLimits limits;
+    limits.cpu_time_ms = qMax(0, problem.time_limit_ms);
+
+    static const QRegularExpression memory_pattern(R"((\d+(?:\.\d+)?)\s*([kmg]?))", QRegularExpression::CaseInsensitiveOption);
+    const QRegularExpressionMatch match = memory_pattern.match(problem.memory_limit);
+    if (match.hasMatch()) {
+        const QString unit = match.captured(2).toLower();
+        const double scale = unit == "k" ? 1 : unit == "g" ? 1024 * 1024 : 1024; // megabytes if not given
+
+        limits.memory_kb = qint64(match.captured(1).toDouble() * scale);
+    }
+
+    return limits;
+}
+
+RunLimits TestRunner::process_limits(const RunLimits &limits) {
+    RunLimits run_limits;
+    run_limits.cpu_time_ms = limits.cpu_time_ms;
+    run_limits.memory_kb = limits.sanitized ? 0 : limits.memory_kb * MEMORY_HEADROOM;
+    run_limits.sanitized = limits.sanitized;
+
+    // a sleeping or blocked program never hits the CPU limit
+    run_limits.wall_time_ms = limits.cpu_time_ms ? qMax(3 * limits.cpu_time_ms, limits.cpu_time_ms + 2000)
+                                                 : DEFAULT_WALL_TIME_MS;
+
+    return run_limits;
+}
+
+TestResult TestRunner::judge(int index, const RunResult &run, const QByteArray &expected, const RunLimits &limits) {
+    TestResult result;
+    result.index = index;
+    result.run = run;
+
+    const bool failed = run.signaled || run.exit_code != 0;
+
+    if (!run.started) {
+        result.verdict = Verdict::FAILED;
+        result.message = run.error;
+    } else if (run.wall_time_exceeded || (limits.cpu_time_ms && run.cpu_time_ms > limits.cpu_time_ms)) {
+        result.verdict = Verdict::TIME_LIMIT;
+        result.message = run.wall_time_exceeded ? "killed after " + QString::number(run.wall_time_ms) + " ms of wall time"
+                                                : "limit is " + QString::number(limits.cpu_time_ms) + " ms";
+    } else if (limits.memory_kb && (run.peak_memory_kb > limits.memory_kb
+                                    || (failed && !limits.sanitized && run.peak_virtual_memory_kb > limits.memory_kb))) {
+        // an allocation failing past the limit usually ends in a crash
+        result.verdict = Verdict::MEMORY_LIMIT;
+        result.message = "limit is " + QString::number(limits.memory_kb / 1024) + " MB";
+    } else if (run.signaled) {
+        result.verdict = Verdict::RUNTIME_ERROR;
+        result.message = "killed by signal " + QString::number(run.signal);
+    } else if (run.exit_code != 0) {
+        result.verdict = Verdict::RUNTIME_ERROR;
+        result.message = "exit code " + QString::number(run.exit_code);
+    } else {
+        const CheckResult check = Checker::compare(run.output, expected);
+        result.verdict = check.ok ? Verdict::ACCEPTED : Verdict::WRONG_ANSWER;
+        result.message = check.message;
+    }
+
+    return result;
+}
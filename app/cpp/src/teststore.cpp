@@ -0,0 +1,140 @@
+#include "teststore.hpp"
+
+#include <QCryptographicHash>
+#include <QDir>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSaveFile>
+#include <QSet>
+#include <QStandardPaths>
+
+TestStore::TestStore(const QString &key)
+    : key(key)
+{
+    const QByteArray hash = QCryptographicHash::hash(key.toUtf8(), QCryptographicHash::Sha1).toHex();
+    test_directory = root() + '/' + QString::fromLatin1(hash.left(16));
+}
+
+QString TestStore::root() {
+    return QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + "/tests";
+}
+
+QVector<TestCase> TestStore::tests() const {
+    QVector<TestCase> result;
+
+    for (const auto &entry : read_index()) {
+        const QString stem = test_directory + '/' + entry.stem;
+        result.push_back({entry.name, stem + ".in", stem + ".ans", stem + ".out"});
+    }
+
+    return result;
+}
+
+bool TestStore::set_samples(const QVector<ProblemExample> &examples) {
+    QVector<Entry> entries;
+    QVector<Entry> old_samples;
+    for (const auto &entry : read_index()) {
+        if (entry.sample) {
+            old_samples.push_back(entry);
+        } else {
+            entries.push_back(entry);
+        }
+    }
+
+    // samples go first, the way the statement lists them
+    QVector<Entry> samples;
+    QSet<QString> stems;
+    for (int i = 0; i < examples.size(); ++i) {
+        const QString stem = "sample" + QString::number(i + 1);
+
+        if (!write_file(stem + ".in", examples[i].input.toUtf8())
+            || !write_file(stem + ".ans", examples[i].output.toUtf8())) {
+            return false;
+        }
+
+        samples.push_back({"Sample " + QString::number(i + 1), stem, true});
+        stems.insert(stem);
+    }
+
+    if (!write_index(samples + entries)) {
+        return false;
+    }
+
+    // the old files go only once the index no longer lists them
+    for (const auto &entry : old_samples) {
+        QFile::remove(test_directory + '/' + entry.stem + ".out");
+        if (!stems.contains(entry.stem)) {
+            QFile::remove(test_directory + '/' + entry.stem + ".in");
+            QFile::remove(test_directory + '/' + entry.stem + ".ans");
+        }
+    }
+
+    return true;
+}
+
+bool TestStore::add(const QString &name, const QByteArray &input, const QByteArray &expected) {
+    QVector<Entry> entries = read_index();
+    const QString stem = next_stem(entries);
+
+    if (!write_file(stem + ".in", input) || !write_file(stem + ".ans", expected)) {
+        return false;
+    }
+
+    entries.push_back({name, stem, false});
+    return write_index(entries);
+}
+
+QVector<TestStore::Entry> TestStore::read_index() const {
+    QFile file(test_directory + "/index.json");
+    if (!file.open(QIODevice::ReadOnly)) {
+        return {};
+    }
+
+    const QJsonObject index = QJsonDocument::fromJson(file.readAll()).object();
+
+    QVector<Entry> entries;
+    for (const auto &value : index["tests"].toArray()) {
+        const QJsonObject test = value.toObject();
+        entries.push_back({test["name"].toString(), test["file"].toString(), test["sample"].toBool()});
+    }
+
+    return entries;
+}
+
+bool TestStore::write_index(const QVector<Entry> &entries) const {
+    QJsonArray tests;
+    for (const auto &entry : entries) {
+        tests.append(QJsonObject{{"name", entry.name}, {"file", entry.stem}, {"sample", entry.sample}});
+    }
+
+    const QJsonObject index{{"key", key}, {"tests", tests}};
+
+    return write_file("index.json", QJsonDocument(index).toJson());
+}
+
+QString TestStore::next_stem(const QVector<Entry> &entries) const {
+    int last = 0;
+    for (const auto &entry : entries) {
+        if (!entry.sample) {
+            last = qMax(last, entry.stem.toInt());
+        }
+    }
+
+    return QString::number(last + 1).rightJustified(3, '0');
+}
+
+bool TestStore::write_file(const QString &file_name, const QByteArray &data) const {
+    if (!QDir().mkpath(test_directory)) {
+        return false;
+    }
+
+    QSaveFile file(test_directory + '/' + file_name);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+
+    file.write(data);
+    return file.commit();
+}
@@ -0,0 +1,172 @@
+#include "textdiff.hpp"
+
+#include <QStringView>
+
+// start offset of every line plus text.size() at the end, lines keep their '\n'
+QVector<int> TextDiff::line_offsets(const QString &text) {
+    QVector<int> offsets = {0};
+
+    for (int pos = text.indexOf('\n'); pos != -1; pos = text.indexOf('\n', pos + 1)) {
+        offsets.push_back(pos + 1);
+    }
+
+    if (offsets.back() != text.size()) {
+        offsets.push_back(text.size());
+    }
+
+    return offsets;
+}
+
+QVector<TextEdit> TextDiff::edits(const QString &before, const QString &after) {
+    const QVector<int> before_lines = line_offsets(before);
+    const QVector<int> after_lines = line_offsets(after);
+
+    QVector<TextEdit> result;
+
+    for (const auto &hunk : diff_lines(before, before_lines, after, after_lines)) {
+        int from = before_lines[hunk.before_from];
+        int to = before_lines[hunk.before_to];
+        int after_from = after_lines[hunk.after_from];
+        int after_to = after_lines[hunk.after_to];
+
+        // narrow the hunk down to the characters that actually differ
+        while (from < to && after_from < after_to && before[from] == after[after_from]) {
+            ++from;
+            ++after_from;
+        }
+
+        while (from < to && after_from < after_to && before[to - 1] == after[after_to - 1]) {
+            --to;
+            --after_to;
+        }
+
+        result.push_back({from, to - from, after.mid(after_from, after_to - after_from)});
+    }
+
+    return result;
+}
+
+QVector<TextDiff::Hunk> TextDiff::diff_lines(const QString &before, const QVector<int> &before_lines,
+                                             const QString &after, const QVector<int> &after_lines) {
+    const auto before_line = [&] (int i) {
+        return QStringView(before).mid(before_lines[i], before_lines[i + 1] - before_lines[i]);
+    };
+    const auto after_line = [&] (int i) {
+        return QStringView(after).mid(after_lines[i], after_lines[i + 1] - after_lines[i]);
+    };
+
+    int begin = 0;
+    int before_end = before_lines.size() - 1;
+    int after_end = after_lines.size() - 1;
+
+    while (begin < before_end && begin < after_end && before_line(begin) == after_line(begin)) {
+        ++begin;
+    }
+
+    while (before_end > begin && after_end > begin
+           && before_line(before_end - 1) == after_line(after_end - 1)) {
+        --before_end;
+        --after_end;
+    }
+
+    const int n = before_end - begin;
+    const int m = after_end - begin;
+
+    if (!n && !m) {
+        return {};
+    }
+
+    const QVector<Hunk> whole = {{begin, before_end, begin, after_end}};
+    if (!n || !m) {
+        return whole;
+    }
+
+    // Myers: v[k] is the furthest x reached on diagonal k, a copy of the
+    // [-d, d] slice is kept per step for backtracking
+    const int max_d = qMin(n + m, MAX_EDIT_LINES);
+    const int offset = max_d + 1;
+
+    QVector<int> v(2 * max_d + 3, 0);
+    QVector<QVector<int>> trace;
+
+    int found_d = -1;
+    for (int d = 0; d <= max_d && found_d == -1; ++d) {
+        for (int k = -d; k <= d; k += 2) {
+            int x;
+            if (k == -d || (k != d && v[offset + k - 1] < v[offset + k + 1])) {
+                x = v[offset + k + 1];
+            } else {
+                x = v[offset + k - 1] + 1;
+            }
+
+            int y = x - k;
+            while (x < n && y < m && before_line(begin + x) == after_line(begin + y)) {
+                ++x;
+                ++y;
+            }
+
+            v[offset + k] = x;
+
+            if (x >= n && y >= m) {
+                found_d = d;
+                break;
+            }
+        }
+
+        trace.push_back(v.mid(offset - d, 2 * d + 1));
+    }
+
+    if (found_d == -1) {
+        return whole; // too different to be worth it
+    }
+
+    // walk back collecting matched line pairs, last to first
+    QVector<QPair<int, int>> matches;
+
+    int x = n;
+    int y = m;
+    for (int d = found_d; d > 0; --d) {
+        const QVector<int> &prev = trace[d - 1];
+        const auto prev_v = [&] (int k) { return prev[k + d - 1]; };
+
+        const int k = x - y;
+        const bool down = k == -d || (k != d && prev_v(k - 1) < prev_v(k + 1));
+        const int prev_k = down ? k + 1 : k - 1;
+        const int prev_x = prev_v(prev_k);
+        const int prev_y = prev_x - prev_k;
+
+        const int snake_x = down ? prev_x : prev_x + 1;
+        const int snake_y = down ? prev_y + 1 : prev_y;
+
+        while (x > snake_x && y > snake_y) {
+            matches.push_back({--x, --y});
+        }
+
+        x = prev_x;
+        y = prev_y;
+    }
+
+    while (x > 0 && y > 0) {
+        matches.push_back({--x, --y});
+    }
+
+    // unmatched runs between consecutive matches become hunks
+    QVector<Hunk> hunks;
+
+    int before_pos = 0;
+    int after_pos = 0;
+    for (auto it = matches.crbegin(); it != matches.crend(); ++it) {
+        if (it->first != before_pos || it->second != after_pos) {
+            hunks.push_back({begin + before_pos, begin + it->first, begin + after_pos, begin + it->second});
+        }
+
+        before_pos = it->first + 1;
+        after_pos = it->second + 1;
+    }
+
+    if (before_pos != n || after_pos != m) {
+        hunks.push_back({begin + before_pos, begin + n, begin + after_pos, begin + m});
+    }
+
+    return hunks;
+}
@@ -17,6 +17,8 @@
 #include <QPointF>
 #include <QFontMetricsF>
 
+#include <stdlib.h>
+
 QLightTerminal::QLightTerminal(QWidget *parent) : QWidget(parent), scrollbar(Qt::Orientation::Vertical),
                                                   boxLayout(this), cursorTimer(this), selectionTimer(this),
                                                   win{0, 0, 0, 0, 100, 10, 10, 1.25, 10, 8.42, 0, 8} {
@@ -71,6 +73,18 @@ void QLightTerminal::runCommand(const QString &command) {
     st->ttywriteraw(command.toStdString().c_str(), command.size());
 }
 
+void QLightTerminal::printOutput(const QByteArray &data) {
+    // processes writing to a pipe use bare newlines, the terminal needs CR too
+    QByteArray output = data;
+    output.replace("\r\n", "\n").replace("\n", "\r\n");
+
+    pendingOutput += output;
+    const int written = st->twrite(pendingOutput.constData(), pendingOutput.size(), 0);
+    pendingOutput.remove(0, written);
+
+    updateTerminal(&st->term);
+}
+
 void QLightTerminal::close() {
     setDisabled(true);
     closed = true;
@@ -178,6 +192,8 @@ void QLightTerminal::paintEvent(QPaintEvent *event) {
     double yPos = i * win.lineheight + win.vPadding;                // y position of the the lastViewPortLine
 
     int temp;
+    int selBegin, selEnd;
+    bool rowSelected;
 
     while (i > stop) {
         i--;
@@ -185,6 +201,9 @@ void QLightTerminal::paintEvent(QPaintEvent *event) {
         offset = win.hPadding;
         line = QString();
 
+        // selected span of this row, computed once instead of per glyph
+        rowSelected = st->selrange(i, &selBegin, &selEnd);
+
         // same logic as TLine from st-utils
         Glyph *tLine = ((i) < st->term.scr ? st->term.hist[((i) + st->term.histi - \
                                                     st->term.scr + HISTSIZE + 1) % HISTSIZE] : \
@@ -207,7 +226,7 @@ void QLightTerminal::paintEvent(QPaintEvent *event) {
                 changed = true;
             }
 
-            if (st->selected(j, i)) {
+            if (rowSelected && BETWEEN(j, selBegin, selEnd)) {
                 g.mode ^= ATTR_REVERSE;
             }
 
@@ -365,9 +384,14 @@ void QLightTerminal::keyPressEvent(QKeyEvent *e) {
             key == 67
             && mods & Qt::KeyboardModifier::ShiftModifier
             && mods & Qt::KeyboardModifier::ControlModifier) {
+        char *selection = st->getsel();
+        if (selection == NULL) {
+            return;
+        }
+
         QClipboard *clipboard = QGuiApplication::clipboard();
-        QString clippedText = QString(st->getsel());
-        clipboard->setText(clippedText);
+        clipboard->setText(QString::fromUtf8(selection));
+        free(selection);
         return;
     }
 
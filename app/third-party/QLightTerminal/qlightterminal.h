@@ -7,6 +7,7 @@
 
 #include <QWidget>
 #include <QStringList>
+#include <QByteArray>
 #include <QScrollBar>
 #include <QHBoxLayout>
 #include <QKeyCombination>
@@ -50,6 +51,18 @@ public:
 
     void setDirectory(const QString &folder_path);
 
+    /*
+     * Prints output of a process started outside the shell, e.g. the
+     * build runner, as if it had come from the pty
+     */
+    void printOutput(const QByteArray &data);
+
+    /*
+     * Direct access to the underlying st state machine,
+     * used to feed recorded output without going through the pty
+     */
+    SimpleTerminal *terminal() const { return st; }
+
 public
     slots:
             void updateTerminal(Term * term);
@@ -107,6 +120,8 @@ private:
 
     double cursorVisible = true;
 
+    QByteArray pendingOutput; // incomplete UTF-8 sequence left over by printOutput
+
     void setupScrollbar();
 
     void updateStyleSheet();
@@ -17,16 +17,19 @@
 #include <libutil.h>
 #endif
 
-SimpleTerminal::SimpleTerminal(QObject *parent) : QObject(parent) {
+SimpleTerminal::SimpleTerminal(QObject *parent, bool spawn_shell) : QObject(parent) {
     readBufSize = sizeof(readBuf) / sizeof(readBuf[0]);
 
     tnew(80, 80);
-    ttynew();
 
-    readNotifier = new QSocketNotifier(master, QSocketNotifier::Read);
-    readNotifier->setEnabled(true);
+    if (spawn_shell) {
+        ttynew();
 
-    connect(readNotifier, &QSocketNotifier::activated, this, &SimpleTerminal::ttyread);
+        readNotifier = new QSocketNotifier(master, QSocketNotifier::Read);
+        readNotifier->setEnabled(true);
+
+        connect(readNotifier, &QSocketNotifier::activated, this, &SimpleTerminal::ttyread);
+    }
 
     // Fix for Zorin OS (error: invalid old space)
     // Needed since we only call realloc later
@@ -34,7 +37,9 @@ SimpleTerminal::SimpleTerminal(QObject *parent) : QObject(parent) {
 }
 
 SimpleTerminal::~SimpleTerminal() {
-    disconnect(readNotifier);
+    if (readNotifier != nullptr) {
+        disconnect(readNotifier);
+    }
 
     for (int i = 0; i <= term.row; i++) {
         free(term.line[i]);
@@ -502,6 +507,10 @@ void SimpleTerminal::ttywriteraw(const char *s, size_t n) {
     ssize_t r;
     size_t lim = 256;
 
+    if (master < 0) {
+        return;
+    }
+
     /*
      * Remember that we are using a pty, which might be a modem line.
      * Writing too much will clog the line. That's why we are doing this
@@ -788,7 +797,7 @@ void SimpleTerminal::tnewline(int first_col) {
 }
 
 void SimpleTerminal::tclearregion(int x1, int y1, int x2, int y2) {
-    int x, y, temp;
+    int x, y, temp, selx1, selx2;
     Glyph *gp;
 
     if (x1 > x2)
@@ -803,10 +812,10 @@ void SimpleTerminal::tclearregion(int x1, int y1, int x2, int y2) {
 
     for (y = y1; y <= y2; y++) {
         term.dirty[y] = 1;
+        if (selrange(y, &selx1, &selx2) && selx1 <= x2 && x1 <= selx2)
+            selclear();
         for (x = x1; x <= x2; x++) {
             gp = &term.line[y][x];
-            if (selected(x, y))
-                selclear();
             gp->fg = term.c.attr.fg;
             gp->bg = term.c.attr.bg;
             gp->mode = 0;
@@ -816,17 +825,31 @@ void SimpleTerminal::tclearregion(int x1, int y1, int x2, int y2) {
 }
 
 int SimpleTerminal::selected(int x, int y) {
+    int x1, x2;
+
+    return selrange(y, &x1, &x2) && BETWEEN(x, x1, x2);
+}
+
+/*
+ * Computes the selected column span [x1, x2] of row y.
+ * Callers walking a whole row should use this once per row
+ * instead of testing every cell with selected().
+ */
+int SimpleTerminal::selrange(int y, int *x1, int *x2) {
     if (sel.mode == SEL_EMPTY || sel.ob.x == -1 ||
-        sel.alt != IS_SET(term.mode, MODE_ALTSCREEN))
+        sel.alt != IS_SET(term.mode, MODE_ALTSCREEN) ||
+        !BETWEEN(y, sel.nb.y, sel.ne.y))
         return 0;
 
-    if (sel.type == SEL_RECTANGULAR)
-        return BETWEEN(y, sel.nb.y, sel.ne.y)
-               && BETWEEN(x, sel.nb.x, sel.ne.x);
+    if (sel.type == SEL_RECTANGULAR) {
+        *x1 = sel.nb.x;
+        *x2 = sel.ne.x;
+    } else {
+        *x1 = (y == sel.nb.y) ? sel.nb.x : 0;
+        *x2 = (y == sel.ne.y) ? sel.ne.x : term.col - 1;
+    }
 
-    return BETWEEN(y, sel.nb.y, sel.ne.y)
-           && (y != sel.nb.y || x >= sel.nb.x)
-           && (y != sel.ne.y || x <= sel.ne.x);
+    return *x1 <= *x2;
 }
 
 void SimpleTerminal::selclear(void) {
@@ -1730,11 +1753,15 @@ char *SimpleTerminal::getsel(void) {
         while (last >= gp && last->u == ' ')
             --last;
 
+        /* runes are encoded straight into the output, ascii needs no encoding */
         for (; gp <= last; ++gp) {
             if (gp->mode & ATTR_WDUMMY)
                 continue;
 
-            ptr += utf8encode(gp->u, ptr);
+            if (gp->u < 0x80)
+                *ptr++ = (char) gp->u;
+            else
+                ptr += utf8encode(gp->u, ptr);
         }
 
         /*
@@ -2190,7 +2217,7 @@ void SimpleTerminal::ttyresize(int tw, int th) {
     wsize.ws_xpixel = tw;
     wsize.ws_ypixel = th;
 
-    if (ioctl(master, TIOCSWINSZ, &wsize) < 0) {
+    if (master > -1 && ioctl(master, TIOCSWINSZ, &wsize) < 0) {
         emit s_error("Couldn't set window size: " + QString(strerror(errno)));
     }
 }
@@ -15,7 +15,9 @@ public:
     Term term;
     Selection sel;
 
-    SimpleTerminal(QObject *parent = nullptr);
+    // without a shell the terminal only parses what is passed to twrite(),
+    // replies to the program are dropped (benchmarks)
+    SimpleTerminal(QObject *parent = nullptr, bool spawn_shell = true);
 
     ~SimpleTerminal();
 
@@ -53,6 +55,8 @@ public:
 
     int selected(int x, int y);
 
+    int selrange(int y, int *x1, int *x2);
+
     void selclear(void);
 
     void selscroll(int orig, int n);
@@ -72,14 +76,14 @@ private:
     TermWindow win;
     winsize wsize;
 
-    int master, slave;
-    pid_t processId;
+    int master = -1, slave = -1;
+    pid_t processId = 0;
 
     char readBuf[BUFSIZ];
     int readBufPos = 0;
     int readBufSize = 0;
 
-    QSocketNotifier *readNotifier;
+    QSocketNotifier *readNotifier = nullptr;
     CSIEscape csiescseq;
     STREscape strescseq;
 
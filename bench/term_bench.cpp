@@ -0,0 +1,253 @@
+// Terminal throughput benchmark
+//
+// Drives SimpleTerminal::twrite with synthetic workloads that mimic what the
+// IDE terminal sees in practice and reports parse throughput, then paints an
+// offscreen QLightTerminal at several sizes and reports frame times.
+//
+// Usage: corgide_term_bench [-i iterations] [-f frames] [recorded.log ...]
+// Extra positional arguments are raw pty captures (e.g. from `script -q`)
+// which are benchmarked alongside the built-in workloads.
+
+#include <QApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QFile>
+#include <QFileInfo>
+#include <QImage>
+#include <QTimer>
+#include <QVector>
+
+#include <cstdio>
+
+#include "qlightterminal.h"
+#include "st.h"
+
+struct Workload
+{
+    QString name;
+    QByteArray data;
+};
+
+static QByteArray make_ascii_flood()
+{
+    static const char line[] =
+        "The quick brown fox jumps over the lazy dog 0123456789 "
+        "abcdefghijklmnopqrstuvwxyz ABCDEFGHIJKLMNOPQRSTUVWXYZ\r\n";
+
+    QByteArray data;
+    for (int i = 0; i < 20000; ++i) {
+        data += line;
+    }
+
+    return data;
+}
+
+static QByteArray make_compiler_diagnostics()
+{
+    QByteArray data;
+    for (int i = 0; i < 4000; ++i) {
+        const QByteArray line_no = QByteArray::number(i % 500 + 1);
+
+        data += "\033[01m\033[Ksolution.cpp:" + line_no + ":17:\033[m\033[K "
+                "\033[01;31m\033[Kerror: \033[m\033[Kno match for '\033[01m\033[Koperator<<\033[m\033[K' "
+                "(operand types are '\033[01m\033[Kstd::ostream\033[m\033[K' and "
+                "'\033[01m\033[Kstd::vector<int>\033[m\033[K')\r\n";
+        data += "  " + line_no + " |     std::cout \033[01;31m\033[K<<\033[m\033[K v << '\\n';\r\n";
+        data += "      |     \033[32m\033[K~~~~~~~~~\033[m\033[K \033[01;31m\033[K^~\033[m\033[K ~\r\n";
+        data += "\033[01m\033[K/usr/include/c++/13/ostream:110:7:\033[m\033[K "
+                "\033[01;36m\033[Knote: \033[m\033[Kcandidate: '\033[01m\033[Kstd::basic_ostream<...>\033[m\033[K'\r\n";
+    }
+
+    return data;
+}
+
+static QByteArray make_utf8_text()
+{
+    static const char line[] =
+        "Минималистичное IDE для спортивного программирования — "
+        "競技プログラミング 用の エディタ · ∑ ∫ √ ≤ ≥ ≠ → ← ✓ ✗\r\n";
+
+    QByteArray data;
+    for (int i = 0; i < 12000; ++i) {
+        data += line;
+    }
+
+    return data;
+}
+
+static QByteArray make_cursor_tui(int cols, int rows)
+{
+    QByteArray data;
+    for (int frame = 0; frame < 200; ++frame) {
+        data += "\033[H\033[2J";
+        for (int y = 1; y <= rows; ++y) {
+            data += "\033[" + QByteArray::number(y) + ";1H";
+            data += "\033[38;5;" + QByteArray::number((y + frame) % 256) + "m";
+            data += "\033[48;2;" + QByteArray::number(y % 256) + ";40;"
+                    + QByteArray::number(frame % 256) + "m";
+
+            QByteArray row(cols - 10, ' ');
+            for (int x = 0; x < row.size(); x += 7) {
+                row[x] = '0' + (x + y + frame) % 10;
+            }
+            data += row;
+            data += "\033[0m\033[K";
+        }
+        data += "\033[" + QByteArray::number(rows / 2) + ";"
+                + QByteArray::number(cols / 2) + "H\033[7m CPU \033[27m";
+    }
+
+    return data;
+}
+
+/*
+ * Feeds the workload in BUFSIZ chunks, carrying incomplete UTF-8
+ * sequences over the same way SimpleTerminal::ttyread does
+ */
+static qint64 feed(SimpleTerminal &st, const QByteArray &data)
+{
+    char buf[BUFSIZ];
+    int buf_pos = 0;
+    qint64 consumed = 0;
+
+    const char *src = data.constData();
+    qint64 left = data.size();
+
+    while (left > 0) {
+        const int chunk = static_cast<int>(qMin<qint64>(left, BUFSIZ - buf_pos));
+        memcpy(buf + buf_pos, src, chunk);
+        src += chunk;
+        left -= chunk;
+        buf_pos += chunk;
+
+        const int written = st.twrite(buf, buf_pos, 0);
+        consumed += written;
+        buf_pos -= written;
+        if (buf_pos > 0) {
+            memmove(buf, buf + written, buf_pos);
+        }
+    }
+
+    return consumed;
+}
+
+static void run_parse_bench(const QVector<Workload> &workloads, int iterations)
+{
+    std::printf("== twrite parse throughput (%d iterations) ==\n", iterations);
+    std::printf("%-24s %12s %12s %10s\n", "workload", "bytes", "ms", "MB/s");
+
+    for (const auto &workload : workloads) {
+        // no shell: nothing else writes to the terminal while it's measured
+        SimpleTerminal st(nullptr, false);
+        st.tresize(120, 40);
+
+        feed(st, workload.data); // warm up
+
+        QElapsedTimer timer;
+        timer.start();
+
+        qint64 bytes = 0;
+        for (int i = 0; i < iterations; ++i) {
+            bytes += feed(st, workload.data);
+        }
+
+        const double ms = timer.nsecsElapsed() / 1e6;
+        const double mb_per_s = (bytes / (1024.0 * 1024.0)) / (ms / 1000.0);
+
+        std::printf("%-24s %12lld %12.2f %10.2f\n",
+                    qPrintable(workload.name), static_cast<long long>(bytes), ms, mb_per_s);
+    }
+}
+
+static void wait_ms(int ms)
+{
+    QEventLoop loop;
+    QTimer::singleShot(ms, &loop, &QEventLoop::quit);
+    loop.exec();
+}
+
+static void run_paint_bench(const QByteArray &fill, int frames)
+{
+    static const QSize sizes[] = { {640, 360}, {1280, 480}, {1920, 1080} };
+
+    std::printf("\n== QLightTerminal offscreen paint (%d frames) ==\n", frames);
+    std::printf("%-12s %10s %12s %10s\n", "size", "grid", "ms/frame", "fps");
+
+    // one widget for every size, each one would spawn a login shell
+    QLightTerminal terminal;
+
+    for (const auto &size : sizes) {
+        terminal.resize(size);
+        terminal.show();
+
+        wait_ms(700); // resizing is debounced by the terminal
+
+        feed(*terminal.terminal(), fill);
+
+        QImage image(size, QImage::Format_ARGB32_Premultiplied);
+
+        terminal.render(&image); // warm up glyph caches
+
+        QElapsedTimer timer;
+        timer.start();
+
+        for (int i = 0; i < frames; ++i) {
+            terminal.render(&image);
+        }
+
+        const double ms = timer.nsecsElapsed() / 1e6;
+        const QString grid = QString::number(terminal.terminal()->term.col) + 'x'
+                             + QString::number(terminal.terminal()->term.row);
+
+        std::printf("%4dx%-7d %10s %12.3f %10.1f\n",
+                    size.width(), size.height(), qPrintable(grid), ms / frames, frames / (ms / 1000.0));
+    }
+
+    // hangs the shell up instead of leaving it behind
+    terminal.terminal()->closePty();
+}
+
+int main(int argc, char *argv[])
+{
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+
+    QApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Terminal throughput benchmark");
+    parser.addHelpOption();
+    QCommandLineOption iterations_option({"i", "iterations"}, "Parse iterations per workload.", "n", "5");
+    QCommandLineOption frames_option({"f", "frames"}, "Frames painted per size.", "n", "200");
+    parser.addOption(iterations_option);
+    parser.addOption(frames_option);
+    parser.addPositionalArgument("recordings", "Raw pty captures to benchmark as extra workloads.", "[files...]");
+    parser.process(app);
+
+    const int iterations = qMax(1, parser.value(iterations_option).toInt());
+    const int frames = qMax(1, parser.value(frames_option).toInt());
+
+    QVector<Workload> workloads = {
+        { "ascii-flood",   make_ascii_flood() },
+        { "ansi-diag",     make_compiler_diagnostics() },
+        { "utf8-text",     make_utf8_text() },
+        { "cursor-tui",    make_cursor_tui(120, 40) },
+    };
+
+    for (const auto &file_name : parser.positionalArguments()) {
+        QFile file(file_name);
+        if (!file.open(QIODevice::ReadOnly)) {
+            std::fprintf(stderr, "Can't open %s: %s\n", qPrintable(file_name), qPrintable(file.errorString()));
+            continue;
+        }
+
+        workloads.push_back({ QFileInfo(file_name).fileName(), file.readAll() });
+    }
+
+    run_parse_bench(workloads, iterations);
+    run_paint_bench(workloads[1].data, frames);
+
+    return 0;
+}